@@ -1,6 +1,235 @@
 #include <SolexOs/Debug.h>
+#include <SolexOs/debug/HexEncode.hpp>
+#include <SolexOs/debug/TraceFilter.hpp>
+#include <SolexOs/debug/TraceRing.hpp>
+#include <SolexOs/debug/TraceTokens.hpp>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace SolexOs {
+  namespace Trace {
+    namespace {
+      std::atomic<uint8_t *> binaryLog(nullptr);
+      uint32_t binaryLogSize = 0;
+      std::atomic<uint32_t> binaryLogUsed(0);
+      std::atomic<uint32_t> binaryLogLost(0);
+
+      using Ring = TraceRing<1024>;
+      using Part = Ring::Part;
+
+      Ring textRing;
+      Ring binaryRing;
+      std::mutex ringControl;
+      std::atomic<bool> ringActive(false);
+      std::atomic<uint32_t> producers(0);
+      std::atomic<bool> draining(false);
+      std::thread drainThread;
+
+      /**
+       * Run PUSH if the rings are running and DIRECT otherwise. A call that sees the rings running is
+       * counted until its push is done so stopRing can wait for it before the final drain.
+       */
+      template<typename PUSH, typename DIRECT>
+      void produce(PUSH push, DIRECT direct) {
+        if( ringActive.load(std::memory_order_relaxed) ) {
+          producers.fetch_add(1);
+          if( ringActive.load() ) {
+            push();
+            producers.fetch_sub(1, std::memory_order_release);
+            return;
+          }
+          producers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        direct();
+      }
+
+      void writeOut(const char *text, size_t length) {
+        std::cout.write(text, static_cast<std::streamsize>(length));
+      }
+
+      /**
+       * All text output goes through here, either straight out or via the ring.
+       */
+      void emit(const char *text, size_t length) {
+        produce([&]() {
+          textRing.push(text, length);
+        }, [&]() {
+          writeOut(text, length);
+        });
+      }
+
+      void emit(const char *text) {
+        emit(text, std::strlen(text));
+      }
+
+      constexpr uint32_t SEGMENTS_PER_WRITE = 16;
+
+      bool binaryMode() {
+        return binaryLog.load(std::memory_order_acquire) != nullptr;
+      }
+
+      /**
+       * Claim length bytes of the binary log for one record, or count a drop and return nullptr if they do
+       * not fit. The claim is a single compare and swap so records never overlap.
+       */
+      uint8_t *reserve(size_t length) {
+        uint8_t *log = binaryLog.load(std::memory_order_acquire);
+        uint32_t used = binaryLogUsed.load(std::memory_order_relaxed);
+        do {
+          if( log == nullptr || length > binaryLogSize - used ) {
+            binaryLogLost.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+          }
+        } while( !binaryLogUsed.compare_exchange_weak(used, static_cast<uint32_t>(used + length),
+            std::memory_order_relaxed) );
+        return log + used;
+      }
+
+      /**
+       * Sink for the binary ring: each record goes into the log whole or is dropped whole.
+       */
+      class BinarySink {
+        private:
+          uint8_t *_out = nullptr;
+          uint32_t _pending = 0;
+
+        public:
+          void operator()(const char *data, size_t length, uint32_t left) {
+            if( _pending == 0 ) {
+              _out = reserve(left);
+              _pending = left;
+            }
+            if( _out != nullptr ) {
+              std::memcpy(_out, data, length);
+              _out += length;
+            }
+            _pending -= static_cast<uint32_t>(length);
+          }
+      };
+
+      BinarySink binarySink;
+
+      uint32_t drainRings() {
+        return textRing.drain(writeOut) + binaryRing.drain(binarySink);
+      }
+
+      void drainLoop() {
+        while( draining.load(std::memory_order_acquire) ) {
+          if( drainRings() == 0 ) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+          }
+        }
+      }
+
+      /**
+       * Stops the rings at exit so the drain thread is joined and the queued output written.
+       */
+      struct StopAtExit {
+          ~StopAtExit() {
+            stopRing();
+          }
+      } stopAtExit;
+
+      uint8_t *putWord(uint8_t *out, uint32_t value) {
+        for( uint32_t i = 0; i < 4; ++i ) {
+          *out++ = static_cast<uint8_t>(value >> (8 * i));
+        }
+        return out;
+      }
+
+      /**
+       * Write one binary record of a header and up to three payload parts, through the binary ring when it
+       * is running or straight into the log.
+       */
+      void writeRecord(const uint8_t *header, size_t headerLength, Part first = {"", 0}, Part second = {"", 0},
+          Part third = {"", 0}) {
+        const Part parts[] = {{header, headerLength}, first, second, third};
+        produce([&]() {
+          binaryRing.push(parts, 4);
+        }, [&]() {
+          const size_t length = headerLength + first.length + second.length + third.length;
+          uint8_t *out = (length <= UINT32_MAX) ? reserve(length) : nullptr;
+          if( out == nullptr ) {
+            return;
+          }
+          for( const Part &part : parts ) {
+            std::memcpy(out, part.data, part.length);
+            out += part.length;
+          }
+        });
+      }
+
+      /**
+       * A TEXT record holding the parts back to back.
+       */
+      void writeText(Part first, Part second = {"", 0}, Part third = {"", 0}) {
+        uint8_t header[5] = {static_cast<uint8_t>(RecordType::TEXT)};
+        putWord(header + 1, static_cast<uint32_t>(first.length + second.length + third.length));
+        writeRecord(header, sizeof(header), first, second, third);
+      }
+
+      void emitToken(uint32_t token) {
+        char buffer[20];
+        emit(buffer, static_cast<size_t>(std::snprintf(buffer, sizeof(buffer), "<token %08X>", token)));
+      }
+    }
+
+    void setBinaryLog(uint8_t *buffer, uint32_t size) {
+      binaryLog.store(nullptr, std::memory_order_release);
+      if( buffer == nullptr ) {
+        return;
+      }
+      binaryLogSize = size;
+      binaryLogUsed.store(0, std::memory_order_relaxed);
+      binaryLogLost.store(0, std::memory_order_relaxed);
+      binaryLog.store(buffer, std::memory_order_release);
+    }
+
+    uint32_t binaryLogLength() {
+      return binaryLogUsed.load(std::memory_order_acquire);
+    }
+
+    uint32_t binaryLogDropped() {
+      return binaryLogLost.load(std::memory_order_relaxed);
+    }
+
+    void startRing() {
+      std::lock_guard<std::mutex> guard(ringControl);
+      if( ringActive.load() ) {
+        return;
+      }
+      textRing.resetDropped();
+      binaryRing.resetDropped();
+      draining.store(true, std::memory_order_release);
+      drainThread = std::thread(drainLoop);
+      ringActive.store(true);
+    }
+
+    void stopRing() {
+      std::lock_guard<std::mutex> guard(ringControl);
+      if( !ringActive.load() ) {
+        return;
+      }
+      ringActive.store(false);
+      while( producers.load() != 0 ) {
+        std::this_thread::yield();
+      }
+      draining.store(false, std::memory_order_release);
+      drainThread.join();
+      drainRings();
+      std::cout.flush();
+    }
+
+    uint32_t droppedRecords() {
+      return textRing.dropped() + binaryRing.dropped();
+    }
+  }
+}
 
 extern "C" {
   uint8_t convertToHex(uint32_t num);
@@ -21,54 +250,91 @@ extern "C" {
   }
 
   void DBG_SendString(uint32_t, uint32_t, const uint8_t* funcName, const uint8_t* msg) {
-    std::cout << reinterpret_cast<const char *>(funcName) << ":" << reinterpret_cast<const char *>(msg);
+    const char *func = reinterpret_cast<const char *>(funcName);
+    const char *text = reinterpret_cast<const char *>(msg);
+    if( SolexOs::Trace::binaryMode() ) {
+      SolexOs::Trace::writeText({func, std::strlen(func)}, {":", 1}, {text, std::strlen(text)});
+      return;
+    }
+    SolexOs::Trace::emit(func);
+    SolexOs::Trace::emit(":", 1);
+    SolexOs::Trace::emit(text);
   }
 
-  void DBG_SendNumber(uint32_t, uint32_t, uint8_t size, uint64_t num) {
-    constexpr auto MAX_DIGITS = 16 + 1;
-    uint32_t digits = size * 2;
-    if( digits >= MAX_DIGITS ) {
-      digits = MAX_DIGITS - 1;
+  void DBG_SendTokens(uint32_t, uint32_t, uint32_t funcToken, uint32_t msgToken, const char *funcName,
+      const char *msg) {
+    using namespace SolexOs::Trace;
+    if( binaryMode() ) {
+      uint8_t record[9] = {static_cast<uint8_t>(RecordType::STRING)};
+      putWord(putWord(record + 1, funcToken), msgToken);
+      writeRecord(record, sizeof(record));
+      return;
     }
-    uint8_t buffer[MAX_DIGITS];
-    for( uint32_t i = 0; i < digits; ++i ) {
-      buffer[i] = convertToHex((num >> (digits - 1 - i) * 4) & 0xF);
+    if( funcName != nullptr ) {
+      emit(funcName);
+    } else {
+      emitToken(funcToken);
+    }
+    emit(":", 1);
+    if( msg != nullptr ) {
+      emit(msg);
+    } else {
+      emitToken(msgToken);
     }
-    buffer[digits] = 0;
-    std::cout << reinterpret_cast<const char *>(buffer);
+  }
+
+  void DBG_SendNumber(uint32_t, uint32_t, uint8_t size, uint64_t num) {
+    if( SolexOs::Trace::binaryMode() ) {
+      const uint32_t bytes = size > 8 ? 8 : size;
+      uint8_t record[10] = {static_cast<uint8_t>(SolexOs::Trace::RecordType::NUMBER), size};
+      for( uint32_t i = 0; i < bytes; ++i ) {
+        record[2 + i] = static_cast<uint8_t>(num >> (8 * i));
+      }
+      SolexOs::Trace::writeRecord(record, 2 + bytes);
+      return;
+    }
+    char buffer[16];
+    SolexOs::Trace::emit(buffer, SolexOs::Trace::encodeNumber(num, size, buffer));
   }
 
   void DBG_SendBuffer(uint32_t, uint32_t, uint32_t len, const uint8_t* buff) {
-    uint8_t buffer[16 * 2 + 2];
-    while (len > 0) {
-      uint32_t segment = len > 16 ? 16 : len;
-      uint8_t *dest = &buffer[0];
-      for( uint32_t i = 0; i < segment; ++i ) {
-        *dest = convertToHex(*buff >> 4);
-        dest++;
-        *dest = convertToHex(*buff);
-        dest++;
-        buff++;
-      }
-      *dest = ' ';
-      dest++;
-      *dest = 0;
-      std::cout << reinterpret_cast<const char *>(buffer);
-      len = len - segment;
+    if( SolexOs::Trace::binaryMode() ) {
+      uint8_t header[5] = {static_cast<uint8_t>(SolexOs::Trace::RecordType::BUFFER)};
+      SolexOs::Trace::putWord(header + 1, len);
+      SolexOs::Trace::writeRecord(header, sizeof(header), {buff, len});
+      return;
+    }
+    constexpr uint32_t CHUNK = SolexOs::Trace::SEGMENT * SolexOs::Trace::SEGMENTS_PER_WRITE;
+    char buffer[SolexOs::Trace::segmentedLength(CHUNK)];
+    while( len > 0 ) {
+      uint32_t chunk = len > CHUNK ? CHUNK : len;
+      SolexOs::Trace::emit(buffer, SolexOs::Trace::encodeSegments(buff, chunk, buffer));
+      buff += chunk;
+      len -= chunk;
     }
   }
 
   void DBG_Space(uint32_t, uint32_t) {
-    std::cout << " ";
+    if( SolexOs::Trace::binaryMode() ) {
+      const uint8_t record = static_cast<uint8_t>(SolexOs::Trace::RecordType::SPACE);
+      SolexOs::Trace::writeRecord(&record, 1);
+      return;
+    }
+    SolexOs::Trace::emit(" ", 1);
   }
 
   void DBG_SendRawString(uint32_t, uint32_t, const char * str) {
-    std::cout << str;
+    if( SolexOs::Trace::binaryMode() ) {
+      SolexOs::Trace::writeText({str, std::strlen(str)});
+      return;
+    }
+    SolexOs::Trace::emit(str);
   }
 
   /**
-   * Don't allow setting from the library.
+   * Set the runtime module mask checked by the TRACE_* sites, bit n enables module n.
    */
-  void DBG_ConfigDebug(uint32_t) {
+  void DBG_ConfigDebug(uint32_t mask) {
+    SolexOs::Trace::moduleMask.store(mask, std::memory_order_relaxed);
   }
 }
@@ -0,0 +1,209 @@
+#include <SolexOs/debug/HexEncode.hpp>
+#include <SolexOs/debug/TraceDecoder.hpp>
+#include <SolexOs/debug/TraceTokens.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+  // bounds of the trace_tokens section, provided by the linker
+  extern const uint8_t __start_trace_tokens[] __attribute__((weak));
+  extern const uint8_t __stop_trace_tokens[] __attribute__((weak));
+}
+
+namespace SolexOs {
+  namespace Trace {
+    namespace {
+      constexpr char SECTION_NAME[] = "trace_tokens";
+
+      uint64_t readLittle(const uint8_t *data, uint32_t size) {
+        uint64_t value = 0;
+        for( uint32_t i = 0; i < size; ++i ) {
+          value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+      }
+
+      uint32_t readWord(const uint8_t *data) {
+        return static_cast<uint32_t>(readLittle(data, 4));
+      }
+
+      void appendToken(std::string &out, const TokenTable &table, uint32_t token) {
+        const char *text = table.lookup(token);
+        if( text != nullptr ) {
+          out += text;
+          return;
+        }
+        char buffer[20];
+        std::snprintf(buffer, sizeof(buffer), "<token %08X>", token);
+        out += buffer;
+      }
+
+      /**
+       * Field offsets of the ELF header and section headers for one class.
+       */
+      struct ElfLayout {
+          uint32_t address;
+          uint32_t sectionOffset;
+          uint32_t sectionEntrySize;
+          uint32_t sectionCount;
+          uint32_t stringSection;
+          uint32_t nameOffset;
+          uint32_t offsetOffset;
+          uint32_t sizeOffset;
+          uint32_t headerSize;
+      };
+
+      constexpr ElfLayout ELF32 = {4, 32, 46, 48, 50, 0, 16, 20, 40};
+      constexpr ElfLayout ELF64 = {8, 40, 58, 60, 62, 0, 24, 32, 64};
+    }
+
+    void TokenTable::add(uint32_t token, const std::string &text) {
+      auto result = _text.emplace(token, text);
+      if( !result.second && result.first->second != text
+          && std::find(_collisions.begin(), _collisions.end(), token) == _collisions.end() ) {
+        _collisions.push_back(token);
+      }
+    }
+
+    bool TokenTable::addSection(const uint8_t *section, size_t length) {
+      size_t position = 0;
+      while( position + TOKEN_HEADER_SIZE <= length ) {
+        const uint32_t token = readWord(section + position);
+        const uint32_t textLength = readWord(section + position + 4);
+        if( token == 0 && textLength == 0 ) {
+          // alignment padding between input sections
+          position += 4;
+          continue;
+        }
+        const size_t padded = (static_cast<size_t>(textLength) + 1 + 3) / 4 * 4;
+        if( padded > length - position - TOKEN_HEADER_SIZE ) {
+          return false;
+        }
+        add(token, std::string(reinterpret_cast<const char *>(section + position + TOKEN_HEADER_SIZE), textLength));
+        position += TOKEN_HEADER_SIZE + padded;
+      }
+      return true;
+    }
+
+    bool TokenTable::addElf(const uint8_t *elf, size_t length) {
+      if( length < 52 || std::memcmp(elf, "\x7F" "ELF", 4) != 0 || elf[5] != 1 ) {
+        return false;
+      }
+      const ElfLayout &layout = (elf[4] == 2) ? ELF64 : ELF32;
+      if( length < layout.headerSize ) {
+        return false;
+      }
+      const uint64_t sectionOffset = readLittle(elf + layout.sectionOffset, layout.address);
+      const uint32_t entrySize = static_cast<uint32_t>(readLittle(elf + layout.sectionEntrySize, 2));
+      const uint32_t count = static_cast<uint32_t>(readLittle(elf + layout.sectionCount, 2));
+      const uint32_t strings = static_cast<uint32_t>(readLittle(elf + layout.stringSection, 2));
+      if( strings >= count || sectionOffset > length
+          || static_cast<uint64_t>(entrySize) * count > length - sectionOffset
+          || entrySize < layout.sizeOffset + layout.address ) {
+        return false;
+      }
+      auto header = [&](uint32_t index) {
+        return elf + sectionOffset + static_cast<uint64_t>(index) * entrySize;
+      };
+      auto offsetOf = [&](uint32_t index) {
+        return readLittle(header(index) + layout.offsetOffset, layout.address);
+      };
+      auto sizeOf = [&](uint32_t index) {
+        return readLittle(header(index) + layout.sizeOffset, layout.address);
+      };
+      const uint64_t namesOffset = offsetOf(strings);
+      const uint64_t namesSize = sizeOf(strings);
+      if( namesOffset > length || namesSize > length - namesOffset ) {
+        return false;
+      }
+      for( uint32_t index = 0; index < count; index++ ) {
+        const uint64_t name = readWord(header(index) + layout.nameOffset);
+        if( name + sizeof(SECTION_NAME) > namesSize
+            || std::memcmp(elf + namesOffset + name, SECTION_NAME, sizeof(SECTION_NAME)) != 0 ) {
+          continue;
+        }
+        const uint64_t offset = offsetOf(index);
+        const uint64_t size = sizeOf(index);
+        if( offset > length || size > length - offset ) {
+          return false;
+        }
+        return addSection(elf + offset, static_cast<size_t>(size));
+      }
+      return false;
+    }
+
+    const char *TokenTable::lookup(uint32_t token) const {
+      auto entry = _text.find(token);
+      return (entry != _text.end()) ? entry->second.c_str() : nullptr;
+    }
+
+    TokenTable TokenTable::linked() {
+      TokenTable table;
+      if( __start_trace_tokens != nullptr ) {
+        table.addSection(__start_trace_tokens, static_cast<size_t>(__stop_trace_tokens - __start_trace_tokens));
+      }
+      return table;
+    }
+
+    std::string decode(const uint8_t *log, size_t length, const TokenTable &table) {
+      std::string out;
+      const uint8_t *end = log + length;
+      auto left = [&]() {
+        return static_cast<size_t>(end - log);
+      };
+      while( left() > 0 ) {
+        RecordType type = static_cast<RecordType>(*log++);
+        switch( type ) {
+          case RecordType::STRING:
+            if( left() < 8 ) {
+              return out;
+            }
+            appendToken(out, table, readWord(log));
+            out += ":";
+            appendToken(out, table, readWord(log + 4));
+            log += 8;
+            break;
+          case RecordType::NUMBER: {
+            if( left() < 1 || left() < 1u + std::min<uint32_t>(log[0], 8) ) {
+              return out;
+            }
+            const uint8_t size = *log++;
+            const uint32_t bytes = std::min<uint32_t>(size, 8);
+            char digits[16];
+            out.append(digits, encodeNumber(readLittle(log, bytes), size, digits));
+            log += bytes;
+            break;
+          }
+          case RecordType::BUFFER: {
+            if( left() < 4 || left() - 4 < readWord(log) ) {
+              return out;
+            }
+            const uint32_t bufferLength = readWord(log);
+            log += 4;
+            const size_t start = out.size();
+            out.resize(start + segmentedLength(bufferLength));
+            encodeSegments(log, bufferLength, &out[start]);
+            log += bufferLength;
+            break;
+          }
+          case RecordType::SPACE:
+            out += ' ';
+            break;
+          case RecordType::TEXT: {
+            if( left() < 4 || left() - 4 < readWord(log) ) {
+              return out;
+            }
+            const uint32_t textLength = readWord(log);
+            out.append(reinterpret_cast<const char *>(log + 4), textLength);
+            log += 4 + textLength;
+            break;
+          }
+          default:
+            return out;
+        }
+      }
+      return out;
+    }
+  }
+}
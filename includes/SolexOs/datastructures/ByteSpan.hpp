@@ -0,0 +1,180 @@
+#ifndef INCLUDES_SOLEXOS_DATASTRUCTURES_BYTESPAN_HPP_
+#define INCLUDES_SOLEXOS_DATASTRUCTURES_BYTESPAN_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace SolexOs {
+
+  /**
+   * A range of bytes that has been checked against its array once, so access inside it is unchecked.
+   *
+   * ByteArray::operator[] checks every index and calls logError on overflow. Loops that already know their
+   * length take a span with validatedSpan() instead: the range is checked once through the array's own
+   * checked access, so an overflow takes the usual logError path, and the loop then indexes a raw pointer
+   * the compiler can vectorise. SpanReadStream and SpanWriteStream do the same for stream decoders.
+   */
+  template<typename T>
+  class Span {
+    private:
+      T *_data;
+      uint32_t _length;
+
+    public:
+      constexpr Span() :
+              _data(nullptr),
+              _length(0) {
+      }
+
+      constexpr Span(T *data, uint32_t length) :
+              _data(data),
+              _length(length) {
+      }
+
+      /**
+       * A span of bytes is also a span of const bytes.
+       */
+      template<typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+      constexpr Span(const Span<U> &other) :
+              _data(other.data()),
+              _length(other.size()) {
+      }
+
+      constexpr uint32_t size() const {
+        return _length;
+      }
+
+      constexpr T *data() const {
+        return _data;
+      }
+
+      constexpr T *begin() const {
+        return _data;
+      }
+
+      constexpr T *end() const {
+        return _data + _length;
+      }
+
+      /**
+       * Unchecked, the index must be less than size().
+       */
+      constexpr T &operator[](uint32_t index) const {
+        return _data[index];
+      }
+
+      /**
+       * Part of this span, unchecked.
+       */
+      constexpr Span subspan(uint32_t offset, uint32_t length) const {
+        return Span(_data + offset, length);
+      }
+
+      void copyFrom(const uint8_t *source) const {
+        std::memcpy(_data, source, _length);
+      }
+
+      void copyTo(uint8_t *destination) const {
+        std::memcpy(destination, _data, _length);
+      }
+  };
+
+  using ByteSpan = Span<uint8_t>;
+  using ConstByteSpan = Span<const uint8_t>;
+
+  namespace detail {
+    /**
+     * Element type of ARRAY's non-const operator[], which must return a reference into the array for a
+     * span to point at. The const operator[] may return by value, so const arrays are addressed through the
+     * non-const one and only read.
+     */
+    template<typename ARRAY>
+    using SpanElement = std::remove_reference_t<decltype(std::declval<std::remove_const_t<ARRAY> &>()[0])>;
+
+    template<typename ARRAY>
+    using SpanOf = Span<std::conditional_t<std::is_const<ARRAY>::value, const SpanElement<ARRAY>, SpanElement<ARRAY>>>;
+  }
+
+  /**
+   * Check that offset..offset+length lies in the array and return it as a span. Out of range goes through
+   * the array's checked operator[] and so its error handling.
+   */
+  template<typename ARRAY>
+  detail::SpanOf<ARRAY> validatedSpan(ARRAY &array, uint32_t offset, uint32_t length) {
+    using Writable = std::remove_const_t<ARRAY>;
+    static_assert(std::is_lvalue_reference<decltype(std::declval<Writable &>()[0])>::value,
+        "operator[] must return a reference into the array");
+    if( length == 0 ) {
+      return detail::SpanOf<ARRAY>();
+    }
+    // first, last and length - 1 in range rules out the end wrapping round
+    static_cast<void>(array[length - 1]);
+    static_cast<void>(array[offset + length - 1]);
+    return detail::SpanOf<ARRAY>(&const_cast<Writable &>(array)[offset], length);
+  }
+
+  template<typename ARRAY>
+  detail::SpanOf<ARRAY> validatedSpan(ARRAY &array) {
+    return validatedSpan(array, 0, array.getLength());
+  }
+
+  /**
+   * Reads values in memory order from a span with no check per read, with the read(T &) and bytesLeft() of
+   * ByteArray's ReadStream. Decoders such as PidTuning::read check bytesLeft() once for the whole record and
+   * then read field by field; over this stream those reads are plain copies. Reading past bytesLeft() is
+   * undefined.
+   */
+  class SpanReadStream {
+    private:
+      const uint8_t *_next;
+      const uint8_t *_end;
+
+    public:
+      explicit SpanReadStream(ConstByteSpan span) :
+              _next(span.begin()),
+              _end(span.end()) {
+      }
+
+      uint32_t bytesLeft() const {
+        return static_cast<uint32_t>(_end - _next);
+      }
+
+      template<typename T>
+      void read(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read as bytes");
+        std::memcpy(&value, _next, sizeof(T));
+        _next += sizeof(T);
+      }
+  };
+
+  /**
+   * Writing counterpart of SpanReadStream, with the write(const T &) of ByteArray's WriteStream. Writing past
+   * bytesLeft() is undefined.
+   */
+  class SpanWriteStream {
+    private:
+      uint8_t *_next;
+      uint8_t *_end;
+
+    public:
+      explicit SpanWriteStream(ByteSpan span) :
+              _next(span.begin()),
+              _end(span.end()) {
+      }
+
+      uint32_t bytesLeft() const {
+        return static_cast<uint32_t>(_end - _next);
+      }
+
+      template<typename T>
+      void write(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written as bytes");
+        std::memcpy(_next, &value, sizeof(T));
+        _next += sizeof(T);
+      }
+  };
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef INCLUDES_SOLEXOS_DATASTRUCTURES_SMALLBYTEARRAY_HPP_
+#define INCLUDES_SOLEXOS_DATASTRUCTURES_SMALLBYTEARRAY_HPP_
+
+#include <SolexOs/datastructures/ByteArray.hpp>
+#include <SolexOs/datastructures/ByteSpan.hpp>
+#include <SolexOs/memory/HeapBlocks.hpp>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace SolexOs {
+
+  /**
+   * A ByteArray that keeps arrays of up to INLINE bytes in the object itself, so short payloads never take a
+   * heap block.
+   *
+   * The bytes are always reached through a ByteArray wrapping either the inline storage or, for a longer
+   * array, a block from BLOCKS (see HeapBlocks.hpp), the way ByteArray wraps a static buffer. Checked
+   * access, the read and write streams, setLength and equality are therefore ByteArray's own, as is the
+   * error handling when they are misused. Longer arrays come from the SmallHeap by default; a product that
+   * fits a SizeClassHeap to its messages passes its blocks instead, and arrays are then limited by its
+   * largest class rather than memory::LARGE - 1.
+   *
+   * Moving a short array copies its inline bytes; it never allocates. Arrays are not copyable, as ByteArray
+   * is not.
+   */
+  template<uint32_t INLINE = 16, typename BLOCKS = memory::SmallHeapBlocks>
+  class SmallByteArray {
+      static_assert(INLINE > 0, "use ByteArray for arrays with no inline storage");
+
+    private:
+      uint8_t _inline[INLINE];
+      uint8_t *_block;
+      uint32_t _capacity;
+      ByteArray _array;
+
+      static uint8_t *blockFor(uint32_t length) {
+        return (length > INLINE) ? BLOCKS::allocate(length) : nullptr;
+      }
+
+      uint8_t *storage() {
+        return (_block != nullptr) ? _block : _inline;
+      }
+
+      void release() {
+        if( _block != nullptr ) {
+          BLOCKS::free(_block);
+          _block = nullptr;
+        }
+      }
+
+      void take(SmallByteArray &other) {
+        release();
+        _block = other._block;
+        _capacity = other._capacity;
+        if( _block == nullptr ) {
+          std::memcpy(_inline, other._inline, _capacity);
+        }
+        _array = ByteArray(storage(), _capacity);
+        _array.setLength(other._array.getLength());
+        other._block = nullptr;
+        other._capacity = 0;
+        other._array = ByteArray(other._inline, 0);
+      }
+
+    public:
+      explicit SmallByteArray(uint32_t length = 0) :
+              _block(blockFor(length)),
+              // a failed allocation that logError returned from leaves an empty array
+              _capacity((length <= INLINE || _block != nullptr) ? length : 0),
+              _array(storage(), _capacity) {
+      }
+
+      SmallByteArray(const uint8_t *data, uint32_t length) :
+              SmallByteArray(length) {
+        if( length > 0 ) {
+          validatedSpan(_array).copyFrom(data);
+        }
+      }
+
+      SmallByteArray(SmallByteArray &&other) :
+              _block(nullptr),
+              _capacity(0),
+              _array(_inline, 0) {
+        take(other);
+      }
+
+      ~SmallByteArray() {
+        release();
+      }
+
+      SmallByteArray &operator=(SmallByteArray &&other) {
+        if( this != &other ) {
+          take(other);
+        }
+        return *this;
+      }
+
+      SmallByteArray(const SmallByteArray &) = delete;
+      SmallByteArray &operator=(const SmallByteArray &) = delete;
+
+      /**
+       * True if the bytes are held in the object rather than a heap block.
+       */
+      bool isInline() const {
+        return _block == nullptr;
+      }
+
+      ByteArray &array() {
+        return _array;
+      }
+
+      const ByteArray &array() const {
+        return _array;
+      }
+
+      uint8_t &operator[](uint32_t index) {
+        return _array[index];
+      }
+
+      decltype(auto) operator[](uint32_t index) const {
+        return _array[index];
+      }
+
+      uint32_t getLength() const {
+        return _array.getLength();
+      }
+
+      void setLength(uint32_t length) {
+        _array.setLength(length);
+      }
+
+      void setBytes(uint32_t offset, const uint8_t *data, uint32_t length) {
+        validatedSpan(_array, offset, length).copyFrom(data);
+      }
+
+      decltype(auto) getWriteStream() {
+        return _array.getWriteStream();
+      }
+
+      decltype(auto) getReadStream() const {
+        return _array.getReadStream();
+      }
+
+      bool operator==(const SmallByteArray &rhs) const {
+        return _array == rhs._array;
+      }
+
+      bool operator==(const ByteArray &rhs) const {
+        return _array == rhs;
+      }
+  };
+}
+
+#endif
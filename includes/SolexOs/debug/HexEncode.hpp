@@ -0,0 +1,169 @@
+#ifndef INCLUDES_SOLEXOS_DEBUG_HEXENCODE_HPP_
+#define INCLUDES_SOLEXOS_DEBUG_HEXENCODE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define HEX_ENCODE_SSSE3
+#endif
+
+/**
+ * Upper case hex encoding for the trace output.
+ *
+ * On x86 blocks of 16 bytes use pshufb when the processor has SSSE3. That path is built for SSSE3 whatever
+ * the build flags and chosen at run time, so the host build needs no -mssse3. Elsewhere 4 bytes at a time
+ * are spread into one nibble per byte of a 64 bit word and turned into digits with SWAR arithmetic, which
+ * suits a Cortex-M without SIMD. Tails use a 256 entry table of digit pairs.
+ */
+namespace SolexOs {
+  namespace Trace {
+
+    namespace Hex {
+      constexpr char digit(uint32_t nibble) {
+        return static_cast<char>(nibble > 9 ? 'A' + nibble - 10 : '0' + nibble);
+      }
+
+      constexpr std::array<char, 512> makePairs() {
+        std::array<char, 512> pairs {};
+        for( uint32_t i = 0; i < 256; i++ ) {
+          pairs[2 * i] = digit(i >> 4);
+          pairs[2 * i + 1] = digit(i & 0xF);
+        }
+        return pairs;
+      }
+
+      constexpr std::array<char, 512> PAIRS = makePairs();
+
+      inline void encodeTable(const uint8_t *data, size_t length, char *out) {
+        for( size_t i = 0; i < length; i++ ) {
+          std::memcpy(out + 2 * i, &PAIRS[2 * data[i]], 2);
+        }
+      }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      /**
+       * Four bytes to eight digits in a 64 bit word.
+       */
+      inline void encodeWord(const uint8_t *data, char *out) {
+        const uint64_t spread = static_cast<uint64_t>(data[0]) | (static_cast<uint64_t>(data[1]) << 16)
+            | (static_cast<uint64_t>(data[2]) << 32) | (static_cast<uint64_t>(data[3]) << 48);
+        const uint64_t nibbles = ((spread >> 4) & 0x000F000F000F000Full) | ((spread & 0x000F000F000F000Full) << 8);
+        // 7 more for the nibbles above 9 to skip from '9' to 'A'
+        const uint64_t letters = ((nibbles + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+        const uint64_t text = nibbles + 0x3030303030303030ull + letters * 7;
+        std::memcpy(out, &text, sizeof(text));
+      }
+#endif
+
+      /**
+       * Any length without SIMD: whole words, then the table.
+       */
+      inline void encodeWords(const uint8_t *data, size_t length, char *out) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while( length >= 4 ) {
+          encodeWord(data, out);
+          data += 4;
+          out += 8;
+          length -= 4;
+        }
+#endif
+        encodeTable(data, length, out);
+      }
+
+#if defined(HEX_ENCODE_SSSE3)
+      inline bool hasSsse3() {
+#if defined(__SSSE3__)
+        return true;
+#else
+        // initialised here as trace may run from a static constructor before the CPU model is read
+        static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3"));
+        return supported;
+#endif
+      }
+
+      /**
+       * The whole 16 byte blocks of the data with pshufb, only to be called if hasSsse3(). Returns the number
+       * of bytes encoded.
+       */
+      __attribute__((target("ssse3")))
+      inline size_t encodeBlocks(const uint8_t *data, size_t length, char *out) {
+        const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D',
+            'E', 'F');
+        const __m128i low = _mm_set1_epi8(0x0F);
+        const size_t blocks = length - length % 16;
+        for( size_t i = 0; i < blocks; i += 16 ) {
+          const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+          const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), low));
+          const __m128i lower = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, low));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), _mm_unpacklo_epi8(high, lower));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16), _mm_unpackhi_epi8(high, lower));
+        }
+        return blocks;
+      }
+#endif
+    }
+
+    /**
+     * Write 2 * length digits for the bytes to out, first byte first. out is not terminated.
+     */
+    inline void encodeHex(const uint8_t *data, size_t length, char *out) {
+#if defined(HEX_ENCODE_SSSE3)
+      if( Hex::hasSsse3() ) {
+        const size_t encoded = Hex::encodeBlocks(data, length, out);
+        data += encoded;
+        out += 2 * encoded;
+        length -= encoded;
+      }
+#endif
+      Hex::encodeWords(data, length, out);
+    }
+
+    /**
+     * The low size bytes of a number as 2 * size digits, most significant first, at most 16 digits.
+     * Returns the number of digits written.
+     */
+    inline uint32_t encodeNumber(uint64_t number, uint32_t size, char *out) {
+      if( size > 8 ) {
+        size = 8;
+      }
+      uint8_t bytes[8];
+      for( uint32_t i = 0; i < size; i++ ) {
+        bytes[i] = static_cast<uint8_t>(number >> (8 * (size - 1 - i)));
+      }
+      Hex::encodeTable(bytes, size, out);
+      return 2 * size;
+    }
+
+    constexpr uint32_t SEGMENT = 16;
+
+    /**
+     * Characters encodeSegments writes for length bytes.
+     */
+    constexpr size_t segmentedLength(size_t length) {
+      return 2 * length + (length + SEGMENT - 1) / SEGMENT;
+    }
+
+    /**
+     * Hex for a buffer as DBG_SendBuffer prints it, SEGMENT bytes at a time each followed by a space.
+     * Returns the number of characters written.
+     */
+    inline size_t encodeSegments(const uint8_t *data, size_t length, char *out) {
+      char *start = out;
+      while( length > 0 ) {
+        const size_t segment = length > SEGMENT ? SEGMENT : length;
+        encodeHex(data, segment, out);
+        out += 2 * segment;
+        *out++ = ' ';
+        data += segment;
+        length -= segment;
+      }
+      return static_cast<size_t>(out - start);
+    }
+  }
+}
+
+#endif
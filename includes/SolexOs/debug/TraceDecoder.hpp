@@ -0,0 +1,71 @@
+#ifndef INCLUDES_SOLEXOS_DEBUG_TRACEDECODER_HPP_
+#define INCLUDES_SOLEXOS_DEBUG_TRACEDECODER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Host side of the tokenised binary trace in TraceTokens.hpp: the token table read from a build and the
+ * decoder that turns a binary log back into text. tools/traceDecode.cpp wraps these for the command line.
+ */
+namespace SolexOs {
+  namespace Trace {
+
+    class TokenTable {
+      private:
+        std::unordered_map<uint32_t, std::string> _text;
+        std::vector<uint32_t> _collisions;
+
+      public:
+        /**
+         * Add one token. The same token for a different text is an FNV collision: the first text is kept
+         * and the token is listed in collisions().
+         */
+        void add(uint32_t token, const std::string &text);
+
+        /**
+         * Add the entries of a trace_tokens section. Returns false if the section is malformed.
+         */
+        bool addSection(const uint8_t *section, size_t length);
+
+        /**
+         * Add the trace_tokens section of a little endian ELF32 or ELF64 image. Returns false if the image
+         * is not one or has no such section.
+         */
+        bool addElf(const uint8_t *elf, size_t length);
+
+        /**
+         * Text for a token, or nullptr if it is not known.
+         */
+        const char *lookup(uint32_t token) const;
+
+        size_t size() const {
+          return _text.size();
+        }
+
+        /**
+         * Tokens more than one text hashes to. The log cannot tell those strings apart, so one of them has
+         * to be reworded.
+         */
+        const std::vector<uint32_t> &collisions() const {
+          return _collisions;
+        }
+
+        /**
+         * The table linked into this program.
+         */
+        static TokenTable linked();
+    };
+
+    /**
+     * Rebuild the text from a binary log. Unknown tokens are shown as <token XXXXXXXX> and a truncated or
+     * unknown record ends the decode.
+     */
+    std::string decode(const uint8_t *log, size_t length, const TokenTable &table);
+  }
+}
+
+#endif
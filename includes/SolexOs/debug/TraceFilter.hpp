@@ -0,0 +1,91 @@
+#ifndef INCLUDES_SOLEXOS_DEBUG_TRACEFILTER_HPP_
+#define INCLUDES_SOLEXOS_DEBUG_TRACEFILTER_HPP_
+
+#include <SolexOs/Debug.h>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Trace filtering by module and level.
+ *
+ * Each trace site names a module (0..31) and a level. Whether a site is built at all is decided at compile
+ * time from the level set for its module: SOLEXOS_TRACE_DEFAULT_LEVEL for every module, overridden per
+ * module with TRACE_MODULE_LEVEL. A site above its module level is discarded by if constexpr, so neither
+ * the call nor its arguments are evaluated or emitted.
+ *
+ * Sites that are built also check the runtime module mask set by DBG_ConfigDebug, a single relaxed load and
+ * bit test. The mask starts with every module enabled.
+ */
+#ifndef SOLEXOS_TRACE_DEFAULT_LEVEL
+#define SOLEXOS_TRACE_DEFAULT_LEVEL SolexOs::Trace::LEVEL_DEBUG
+#endif
+
+namespace SolexOs {
+  namespace Trace {
+
+    constexpr uint32_t LEVEL_NONE = 0;
+    constexpr uint32_t LEVEL_ERROR = 1;
+    constexpr uint32_t LEVEL_WARNING = 2;
+    constexpr uint32_t LEVEL_INFO = 3;
+    constexpr uint32_t LEVEL_DEBUG = 4;
+
+    constexpr uint32_t MAX_MODULES = 32;
+
+    /**
+     * Compile time level for a module. Specialise with TRACE_MODULE_LEVEL.
+     */
+    template<uint32_t MODULE>
+    struct ModuleLevel {
+        static constexpr uint32_t value = SOLEXOS_TRACE_DEFAULT_LEVEL;
+    };
+
+    template<uint32_t MODULE, uint32_t LEVEL>
+    constexpr bool compiledIn() {
+      static_assert(MODULE < MAX_MODULES, "trace module must be less than 32");
+      return LEVEL <= ModuleLevel<MODULE>::value;
+    }
+
+    /**
+     * Runtime enable bit per module, written by DBG_ConfigDebug.
+     */
+    inline std::atomic<uint32_t> moduleMask(0xFFFFFFFFu);
+
+    inline bool enabled(uint32_t module) {
+      return (moduleMask.load(std::memory_order_relaxed) & (1u << module)) != 0;
+    }
+  }
+}
+
+/**
+ * Set the compile time level of one module. Use at global scope before the module's trace sites.
+ */
+#define TRACE_MODULE_LEVEL(MODULE, LEVEL) \
+  template<> struct SolexOs::Trace::ModuleLevel<(MODULE)> { \
+      static constexpr uint32_t value = (LEVEL); \
+  }
+
+/**
+ * Run STATEMENT only if the site is compiled in and its module is enabled at run time.
+ */
+#define TRACE_IF(MODULE, LEVEL, STATEMENT) \
+  do { \
+    if constexpr( SolexOs::Trace::compiledIn<(MODULE), (LEVEL)>() ) { \
+      if( SolexOs::Trace::enabled(MODULE) ) { \
+        STATEMENT; \
+      } \
+    } \
+  } while( 0 )
+
+#define TRACE_SEND_STRING(MODULE, LEVEL, FUNC, MSG) \
+  TRACE_IF(MODULE, LEVEL, DBG_SendString(MODULE, LEVEL, reinterpret_cast<const uint8_t *>(FUNC), \
+      reinterpret_cast<const uint8_t *>(MSG)))
+
+#define TRACE_SEND_NUMBER(MODULE, LEVEL, SIZE, NUM) TRACE_IF(MODULE, LEVEL, DBG_SendNumber(MODULE, LEVEL, SIZE, NUM))
+
+#define TRACE_SEND_BUFFER(MODULE, LEVEL, LEN, BUFF) TRACE_IF(MODULE, LEVEL, DBG_SendBuffer(MODULE, LEVEL, LEN, BUFF))
+
+#define TRACE_SPACE(MODULE, LEVEL) TRACE_IF(MODULE, LEVEL, DBG_Space(MODULE, LEVEL))
+
+#define TRACE_RAW_STRING(MODULE, LEVEL, STR) TRACE_IF(MODULE, LEVEL, DBG_SendRawString(MODULE, LEVEL, STR))
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef INCLUDES_SOLEXOS_DEBUG_TRACERING_HPP_
+#define INCLUDES_SOLEXOS_DEBUG_TRACERING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace SolexOs {
+  namespace Trace {
+
+    /**
+     * Bounded lock-free ring of trace records for many producers and one consumer.
+     *
+     * Each slot carries a sequence number. A producer claims every slot its record needs with one compare
+     * and swap on the write position, copies the record in and publishes each slot by advancing its
+     * sequence. Records therefore never interleave, and producers never wait on each other or on the output.
+     * When there are not enough free slots the whole record is dropped and counted rather than blocking the
+     * caller. The single consumer (the drain thread on host, the idle task or a DMA complete handler on
+     * target) takes published slots in order and hands them to a sink.
+     *
+     * Each slot holds the bytes of its record left from that slot on, so a sink that needs whole records
+     * knows the record length from its first slot.
+     */
+    template<uint32_t SLOTS, uint32_t SLOT_SIZE = 64>
+    class TraceRing {
+        static_assert((SLOTS & (SLOTS - 1)) == 0, "slots must be a power of two");
+        static_assert(SLOT_SIZE > sizeof(uint32_t), "a slot needs room for its length and some text");
+      public:
+        static constexpr uint32_t TEXT_SIZE = SLOT_SIZE - sizeof(uint32_t);
+        static constexpr size_t CAPACITY = static_cast<size_t>(SLOTS) * TEXT_SIZE;
+
+        /**
+         * One piece of a record gathered by push.
+         */
+        struct Part {
+            const void *data;
+            size_t length;
+        };
+
+      private:
+        struct Slot {
+            std::atomic<uint32_t> sequence;
+            uint32_t left;
+            char text[TEXT_SIZE];
+        };
+
+        Slot _slots[SLOTS];
+        std::atomic<uint32_t> _head;
+        uint32_t _tail;
+        std::atomic<uint32_t> _dropped;
+
+        int32_t ahead(uint32_t position) const {
+          const Slot &slot = _slots[position & (SLOTS - 1)];
+          return static_cast<int32_t>(slot.sequence.load(std::memory_order_acquire) - position);
+        }
+
+        /**
+         * Claim count slots, returning the first position, or false if they are not all free. The consumer
+         * frees slots in order, so the last being free means all of them are.
+         */
+        bool claim(uint32_t count, uint32_t &position) {
+          position = _head.load(std::memory_order_relaxed);
+          for( ;; ) {
+            const int32_t difference = ahead(position + count - 1);
+            if( difference == 0 ) {
+              if( _head.compare_exchange_weak(position, position + count, std::memory_order_relaxed) ) {
+                return true;
+              }
+            } else if( difference < 0 ) {
+              return false;
+            } else {
+              position = _head.load(std::memory_order_relaxed);
+            }
+          }
+        }
+
+        bool drop() {
+          _dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+
+      public:
+        TraceRing() :
+                _head(0),
+                _tail(0),
+                _dropped(0) {
+          for( uint32_t i = 0; i < SLOTS; i++ ) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+          }
+        }
+
+        TraceRing(const TraceRing &) = delete;
+        TraceRing &operator=(const TraceRing &) = delete;
+
+        /**
+         * Queue a record made of the parts, back to back, from any thread or interrupt. Returns false and
+         * counts a drop if there is no room for all of it.
+         */
+        bool push(const Part *parts, uint32_t count) {
+          size_t length = 0;
+          for( uint32_t i = 0; i < count; i++ ) {
+            length += parts[i].length;
+          }
+          if( length == 0 ) {
+            return true;
+          }
+          if( length > CAPACITY ) {
+            return drop();
+          }
+          const uint32_t needed = static_cast<uint32_t>((length + TEXT_SIZE - 1) / TEXT_SIZE);
+          uint32_t position;
+          if( !claim(needed, position) ) {
+            return drop();
+          }
+          uint32_t left = static_cast<uint32_t>(length);
+          const char *source = static_cast<const char *>(parts->data);
+          size_t sourceLeft = parts->length;
+          for( uint32_t i = 0; i < needed; i++, position++ ) {
+            Slot &slot = _slots[position & (SLOTS - 1)];
+            slot.left = left;
+            const uint32_t segment = left > TEXT_SIZE ? TEXT_SIZE : left;
+            for( uint32_t copied = 0; copied < segment; ) {
+              while( sourceLeft == 0 ) {
+                ++parts;
+                source = static_cast<const char *>(parts->data);
+                sourceLeft = parts->length;
+              }
+              const uint32_t want = segment - copied;
+              const uint32_t chunk = (want < sourceLeft) ? want : static_cast<uint32_t>(sourceLeft);
+              std::memcpy(slot.text + copied, source, chunk);
+              copied += chunk;
+              source += chunk;
+              sourceLeft -= chunk;
+            }
+            left -= segment;
+            slot.sequence.store(position + 1, std::memory_order_release);
+          }
+          return true;
+        }
+
+        bool push(const char *text, size_t length) {
+          const Part part = {text, length};
+          return push(&part, 1);
+        }
+
+        /**
+         * Hand every published slot in order to SINK(const char *, size_t), or to
+         * SINK(const char *, size_t, uint32_t left) for a sink that wants the record bytes left from this
+         * slot on. Only one thread may drain. Returns the number of slots drained.
+         */
+        template<typename SINK>
+        uint32_t drain(SINK &&sink) {
+          uint32_t drained = 0;
+          for( ;; ) {
+            Slot &slot = _slots[_tail & (SLOTS - 1)];
+            if( slot.sequence.load(std::memory_order_acquire) != _tail + 1 ) {
+              return drained;
+            }
+            const size_t length = slot.left > TEXT_SIZE ? TEXT_SIZE : slot.left;
+            if constexpr( std::is_invocable<SINK, const char *, size_t, uint32_t>::value ) {
+              sink(slot.text, length, slot.left);
+            } else {
+              sink(slot.text, length);
+            }
+            slot.sequence.store(_tail + SLOTS, std::memory_order_release);
+            _tail++;
+            drained++;
+          }
+        }
+
+        /**
+         * Records lost because the ring was full.
+         */
+        uint32_t dropped() const {
+          return _dropped.load(std::memory_order_relaxed);
+        }
+
+        void resetDropped() {
+          _dropped.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * Route the output of the DBG_* calls, text or binary, through rings drained by a background thread
+     * instead of writing it synchronously. stopRing() waits for calls already pushing, drains what is left
+     * and returns to synchronous output; it also runs at exit.
+     */
+    void startRing();
+    void stopRing();
+
+    /**
+     * Trace records dropped by the rings since they were started.
+     */
+    uint32_t droppedRecords();
+  }
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef INCLUDES_SOLEXOS_DEBUG_TRACETOKENS_HPP_
+#define INCLUDES_SOLEXOS_DEBUG_TRACETOKENS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Tokenised binary trace.
+ *
+ * In binary mode the DBG_* calls write a compact record to a fixed log buffer instead of formatting text.
+ * Strings given to TRACE_STRING are sent as 32 bit tokens (FNV-1a of the text) computed at compile time, so
+ * the call site only passes two constants. Numbers and buffers are copied raw and strings passed to the
+ * DBG_* calls as pointers are copied as text. The text is rebuilt off line by the decoder in
+ * TraceDecoder.hpp, which gives exactly what text mode would have printed.
+ *
+ * The text of each TRACE_TOKEN is held, with its token, only in the trace_tokens section. Host builds link
+ * that section normally and the tests read it in place. Target builds add traceTokens.ld to the linker
+ * script, which keeps the section in the ELF for the decoder but out of the loaded image, and define
+ * TRACE_TOKENS_ONLY so TRACE_STRING does not also pass the literals for text mode.
+ *
+ * Each record is reserved in the log with one compare and swap and is written whole or dropped whole, so
+ * the log can be written from any thread or interrupt. Read it once tracing has stopped.
+ */
+namespace SolexOs {
+  namespace Trace {
+
+    constexpr uint32_t FNV_OFFSET = 2166136261u;
+    constexpr uint32_t FNV_PRIME = 16777619u;
+
+    constexpr uint32_t tokenOf(const char *text) {
+      uint32_t hash = FNV_OFFSET;
+      while( *text != 0 ) {
+        hash = (hash ^ static_cast<uint8_t>(*text)) * FNV_PRIME;
+        ++text;
+      }
+      return hash;
+    }
+
+    /**
+     * An entry of the trace_tokens section. The text is zero padded to a multiple of 4 so entries follow
+     * each other without gaps: token, length, then the text.
+     */
+    template<size_t N>
+    struct TokenRecord {
+        uint32_t token;
+        uint32_t length;
+        char text[(N + 3) / 4 * 4];
+    };
+
+    constexpr size_t TOKEN_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    template<size_t N>
+    constexpr TokenRecord<N> makeTokenRecord(const char (&text)[N]) {
+      TokenRecord<N> record {tokenOf(text), static_cast<uint32_t>(N - 1), {}};
+      for( size_t i = 0; i + 1 < N; i++ ) {
+        record.text[i] = text[i];
+      }
+      return record;
+    }
+
+    enum class RecordType : uint8_t {
+      STRING = 1,
+      NUMBER = 2,
+      BUFFER = 3,
+      SPACE = 4,
+      TEXT = 5
+    };
+
+    /**
+     * Write binary records to buffer rather than text. nullptr returns to text mode. Other threads must have
+     * stopped tracing before the log is changed.
+     */
+    void setBinaryLog(uint8_t *buffer, uint32_t size);
+
+    /**
+     * Bytes of whole records in the last binary log set. Its length and drops are kept after returning to
+     * text mode.
+     */
+    uint32_t binaryLogLength();
+
+    /**
+     * Records that did not fit in the last binary log set.
+     */
+    uint32_t binaryLogDropped();
+  }
+}
+
+extern "C" {
+  /**
+   * DBG_SendString with both strings already tokenised. Text mode prints funcName and msg, or the tokens if
+   * they are nullptr.
+   */
+  void DBG_SendTokens(uint32_t, uint32_t, uint32_t funcToken, uint32_t msgToken, const char *funcName,
+      const char *msg);
+}
+
+/**
+ * Token for a string literal, computed at compile time with the text recorded in the token table.
+ */
+#define TRACE_TOKEN(TEXT) \
+  ([]() { \
+    static constexpr auto record __attribute__((used, section("trace_tokens"), aligned(4))) = \
+        SolexOs::Trace::makeTokenRecord(TEXT); \
+    return record.token; \
+  }())
+
+/**
+ * Equivalent of DBG_SendString for literals that only sends the tokens in binary mode.
+ */
+#ifdef TRACE_TOKENS_ONLY
+#define TRACE_STRING(MODULE, LEVEL, FUNC, MSG) \
+  DBG_SendTokens(MODULE, LEVEL, TRACE_TOKEN(FUNC), TRACE_TOKEN(MSG), nullptr, nullptr)
+#else
+#define TRACE_STRING(MODULE, LEVEL, FUNC, MSG) \
+  DBG_SendTokens(MODULE, LEVEL, TRACE_TOKEN(FUNC), TRACE_TOKEN(MSG), FUNC, MSG)
+#endif
+
+#endif
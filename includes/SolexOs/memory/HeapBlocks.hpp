@@ -0,0 +1,48 @@
+#ifndef INCLUDES_SOLEXOS_MEMORY_HEAPBLOCKS_HPP_
+#define INCLUDES_SOLEXOS_MEMORY_HEAPBLOCKS_HPP_
+
+#include <SolexOs/memory/SmallHeap.hpp>
+#include <cstdint>
+
+namespace memory {
+
+  /**
+   * Where a container such as SolexOs::SmallByteArray gets its heap blocks: a type with
+   *   static uint8_t *allocate(uint32_t size);
+   *   static void free(uint8_t *block);
+   * where allocate reports failure through logError as the heaps do.
+   */
+
+  /**
+   * Blocks from the global SmallHeap.
+   */
+  struct SmallHeapBlocks {
+      static uint8_t *allocate(uint32_t size) {
+        return allocateSmallBlock(size);
+      }
+
+      static void free(uint8_t *block) {
+        freeSmallBlock(block);
+      }
+  };
+
+  /**
+   * Blocks from a heap instance with allocate and free members, such as a product's SizeClassHeap or a
+   * ThreadCachedHeap over one:
+   *   Heap messageHeap;
+   *   using MessageBlocks = memory::HeapBlocks<Heap, messageHeap>;
+   */
+  template<typename HEAP, HEAP &heap>
+  struct HeapBlocks {
+      static uint8_t *allocate(uint32_t size) {
+        return heap.allocate(size);
+      }
+
+      static void free(uint8_t *block) {
+        heap.free(block);
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef INCLUDES_SOLEXOS_MEMORY_SIZECLASSHEAP_HPP_
+#define INCLUDES_SOLEXOS_MEMORY_SIZECLASSHEAP_HPP_
+
+#include <SolexOs/Assert.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace memory {
+
+  /**
+   * Report a heap that is exhausted or given a block it does not own, through logError as SmallHeap does.
+   * info is the size requested or the low 32 bits of the address freed. The library keeps SmallHeap's
+   * codes to itself, so this uses the first recovery option and error code until Assert.hpp has heap ones.
+   */
+  inline void heapError(uint32_t info) {
+    logError(static_cast<Assert::FatalRecoveryOption>(0), static_cast<Assert::FatalErrorCode>(0), info);
+  }
+
+  /**
+   * One pool of a SizeClassHeap: COUNT blocks of SIZE bytes.
+   */
+  template<uint32_t SIZE, uint32_t COUNT>
+  struct SizeClass {
+      static constexpr uint32_t size = SIZE;
+      static constexpr uint32_t count = COUNT;
+  };
+
+  /**
+   * Fixed block heap with any number of size classes, each a SizeClass<SIZE, COUNT> in increasing size.
+   *
+   * The pools share one statically sized store laid out at compile time, and the request size to class
+   * lookup is a constexpr table indexed in steps of GRANULE bytes, so allocation is a table load and a free
+   * list pop. Free lists hold block indices rather than pointers so blocks can be as small as GRANULE.
+   *
+   * A product fits the classes to its message sizes, for example
+   *   using Heap = SizeClassHeap<SizeClass<16, 32>, SizeClass<48, 16>, SizeClass<128, 8>, SizeClass<256, 4>>;
+   *
+   * A request larger than the largest class or for an exhausted class calls logError from allocate, and
+   * returns nullptr from tryAllocate; a request never spills into a larger class. Freeing a pointer that is
+   * not a block of this heap calls logError and leaves the heap unchanged.
+   */
+  template<typename ... CLASSES>
+  class SizeClassHeap {
+    public:
+      static constexpr uint32_t CLASS_COUNT = sizeof...(CLASSES);
+      static constexpr uint32_t GRANULE = 4;
+      static constexpr uint32_t NO_CLASS = CLASS_COUNT;
+
+      static constexpr std::array<uint32_t, CLASS_COUNT> SIZES = {CLASSES::size...};
+      static constexpr std::array<uint32_t, CLASS_COUNT> COUNTS = {CLASSES::count...};
+
+    private:
+      static_assert(CLASS_COUNT > 0, "at least one size class is needed");
+
+      static constexpr bool validClasses() {
+        for( uint32_t i = 0; i < CLASS_COUNT; i++ ) {
+          if( SIZES[i] == 0 || SIZES[i] % GRANULE != 0 || COUNTS[i] == 0 ) {
+            return false;
+          }
+          if( i > 0 && SIZES[i] <= SIZES[i - 1] ) {
+            return false;
+          }
+        }
+        return true;
+      }
+      static_assert(validClasses(), "sizes must be increasing multiples of 4 and counts non zero");
+
+      template<typename RESULT, typename FUNCTION>
+      static constexpr std::array<RESULT, CLASS_COUNT + 1> prefix(FUNCTION function) {
+        std::array<RESULT, CLASS_COUNT + 1> result {};
+        for( uint32_t i = 0; i < CLASS_COUNT; i++ ) {
+          result[i + 1] = result[i] + function(i);
+        }
+        return result;
+      }
+
+      // first byte and first block index of each class, plus the totals at the end
+      static constexpr std::array<uint32_t, CLASS_COUNT + 1> OFFSETS = prefix<uint32_t>([](uint32_t i) {
+        return SIZES[i] * COUNTS[i];
+      });
+      static constexpr std::array<uint32_t, CLASS_COUNT + 1> FIRST_BLOCK = prefix<uint32_t>([](uint32_t i) {
+        return COUNTS[i];
+      });
+
+      static constexpr uint32_t MAX_SIZE = SIZES[CLASS_COUNT - 1];
+      static constexpr uint32_t TOTAL_BYTES = OFFSETS[CLASS_COUNT];
+      static constexpr uint32_t TOTAL_BLOCKS = FIRST_BLOCK[CLASS_COUNT];
+      static_assert(TOTAL_BLOCKS < 0xFFFF, "block indices are 16 bit");
+
+      using Index = uint16_t;
+      static constexpr Index END = 0xFFFF;
+
+      static constexpr std::array<uint8_t, MAX_SIZE / GRANULE + 1> makeLookup() {
+        std::array<uint8_t, MAX_SIZE / GRANULE + 1> lookup {};
+        uint32_t sizeClass = 0;
+        for( uint32_t step = 0; step <= MAX_SIZE / GRANULE; step++ ) {
+          while( SIZES[sizeClass] < step * GRANULE ) {
+            sizeClass++;
+          }
+          lookup[step] = static_cast<uint8_t>(sizeClass);
+        }
+        return lookup;
+      }
+
+      static constexpr std::array<uint8_t, MAX_SIZE / GRANULE + 1> LOOKUP = makeLookup();
+
+      alignas(std::max_align_t) uint8_t _store[TOTAL_BYTES];
+      Index _next[TOTAL_BLOCKS];
+      Index _head[CLASS_COUNT];
+      uint32_t _free[CLASS_COUNT];
+
+      uint8_t *blockAt(uint32_t sizeClass, uint32_t block) {
+        return &_store[OFFSETS[sizeClass] + (block - FIRST_BLOCK[sizeClass]) * SIZES[sizeClass]];
+      }
+
+    public:
+      SizeClassHeap() {
+        reset();
+      }
+
+      SizeClassHeap(const SizeClassHeap &) = delete;
+      SizeClassHeap &operator=(const SizeClassHeap &) = delete;
+
+      /**
+       * Class that serves a request, NO_CLASS if it is too large.
+       */
+      static constexpr uint32_t classFor(uint32_t size) {
+        return (size > MAX_SIZE) ? NO_CLASS : LOOKUP[(size + GRANULE - 1) / GRANULE];
+      }
+
+      static constexpr uint32_t maxAllocation() {
+        return MAX_SIZE;
+      }
+
+      /**
+       * Return every block, invalidating any still in use.
+       */
+      void reset() {
+        for( uint32_t sizeClass = 0; sizeClass < CLASS_COUNT; sizeClass++ ) {
+          const uint32_t first = FIRST_BLOCK[sizeClass];
+          const uint32_t last = FIRST_BLOCK[sizeClass + 1] - 1;
+          for( uint32_t block = first; block < last; block++ ) {
+            _next[block] = static_cast<Index>(block + 1);
+          }
+          _next[last] = END;
+          _head[sizeClass] = static_cast<Index>(first);
+          _free[sizeClass] = COUNTS[sizeClass];
+        }
+      }
+
+      uint8_t *allocate(uint32_t size) {
+        uint8_t *block = tryAllocate(size);
+        if( block == nullptr ) {
+          heapError(size);
+        }
+        return block;
+      }
+
+      /**
+       * allocate that returns nullptr rather than calling logError, for callers that can wait or go elsewhere.
+       */
+      uint8_t *tryAllocate(uint32_t size) {
+        const uint32_t sizeClass = classFor(size);
+        if( sizeClass == NO_CLASS || _head[sizeClass] == END ) {
+          return nullptr;
+        }
+        const Index block = _head[sizeClass];
+        _head[sizeClass] = _next[block];
+        _free[sizeClass]--;
+        return blockAt(sizeClass, block);
+      }
+
+      /**
+       * Return a block from allocate. nullptr is ignored.
+       */
+      void free(uint8_t *pointer) {
+        if( pointer == nullptr ) {
+          return;
+        }
+        const uint32_t sizeClass = classOf(pointer);
+        if( sizeClass == NO_CLASS ) {
+          return;
+        }
+        const uint32_t offset = static_cast<uint32_t>(pointer - _store);
+        const Index block = static_cast<Index>(
+            FIRST_BLOCK[sizeClass] + (offset - OFFSETS[sizeClass]) / SIZES[sizeClass]);
+        _next[block] = _head[sizeClass];
+        _head[sizeClass] = block;
+        _free[sizeClass]++;
+      }
+
+      /**
+       * Class of a block from allocate. A pointer outside the heap or not at the start of a block calls
+       * logError and gives NO_CLASS.
+       */
+      uint32_t classOf(const uint8_t *pointer) const {
+        if( !owns(pointer) ) {
+          heapError(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer)));
+          return NO_CLASS;
+        }
+        const uint32_t offset = static_cast<uint32_t>(pointer - _store);
+        uint32_t sizeClass = 0;
+        while( offset >= OFFSETS[sizeClass + 1] ) {
+          sizeClass++;
+        }
+        if( (offset - OFFSETS[sizeClass]) % SIZES[sizeClass] != 0 ) {
+          heapError(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer)));
+          return NO_CLASS;
+        }
+        return sizeClass;
+      }
+
+      /**
+       * True if the pointer is a block of this heap.
+       */
+      bool owns(const uint8_t *pointer) const {
+        return pointer >= _store && pointer < _store + TOTAL_BYTES;
+      }
+
+      uint32_t freeSpace(uint32_t sizeClass) const {
+        return _free[sizeClass];
+      }
+
+      /**
+       * Bytes of its block a request of this size leaves unused.
+       */
+      static constexpr uint32_t wastedBytes(uint32_t size) {
+        return (classFor(size) == NO_CLASS) ? 0 : SIZES[classFor(size)] - size;
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef INCLUDES_SOLEXOS_MEMORY_THREADCACHEDHEAP_HPP_
+#define INCLUDES_SOLEXOS_MEMORY_THREADCACHEDHEAP_HPP_
+
+#include <SolexOs/memory/SizeClassHeap.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace memory {
+
+  /**
+   * A SizeClassHeap shared by several host threads, with a small cache of blocks per thread and class.
+   *
+   * Allocation and free normally only touch the calling thread's cache. An empty cache is refilled with
+   * BATCH blocks, and a cache holding 2 * BATCH blocks returns BATCH of them, both in one pass under the
+   * heap lock, so threads meet on the lock once per BATCH operations rather than on every one. Blocks may be
+   * freed on a different thread from the one that allocated them.
+   *
+   * Blocks in a cache count as in use in freeSpace(); flush() returns the calling thread's cache and a thread
+   * returns its cache when it exits. The heap must outlive every thread that uses it, and a thread is only
+   * meant to use one heap of a given type (normally a static instance, as the global HEAP is).
+   *
+   * This is for host builds; on target the plain heap is used from one task.
+   */
+  template<typename HEAP, uint32_t BATCH = 8>
+  class ThreadCachedHeap {
+    private:
+      static constexpr uint32_t CLASSES = HEAP::CLASS_COUNT;
+      static constexpr uint32_t CACHE_SIZE = 2 * BATCH;
+
+      struct Cache {
+          ThreadCachedHeap *owner = nullptr;
+          uint8_t *blocks[CLASSES][CACHE_SIZE];
+          uint32_t count[CLASSES] = {};
+
+          ~Cache() {
+            if( owner != nullptr ) {
+              owner->flush(*this);
+            }
+          }
+      };
+
+      HEAP _heap;
+      std::mutex _lock;
+      std::atomic<uint32_t> _transfers;
+
+      static Cache &threadCache() {
+        static thread_local Cache cache;
+        return cache;
+      }
+
+      Cache &cache() {
+        Cache &cache = threadCache();
+        if( cache.owner != this ) {
+          if( cache.owner != nullptr ) {
+            cache.owner->flush(cache);
+          }
+          cache.owner = this;
+        }
+        return cache;
+      }
+
+      void refill(Cache &cache, uint32_t sizeClass) {
+        std::lock_guard<std::mutex> guard(_lock);
+        _transfers.fetch_add(1, std::memory_order_relaxed);
+        uint32_t &count = cache.count[sizeClass];
+        while( count < BATCH ) {
+          uint8_t *block = _heap.tryAllocate(HEAP::SIZES[sizeClass]);
+          if( block == nullptr ) {
+            return;
+          }
+          cache.blocks[sizeClass][count++] = block;
+        }
+      }
+
+      void release(Cache &cache, uint32_t sizeClass, uint32_t keep) {
+        std::lock_guard<std::mutex> guard(_lock);
+        _transfers.fetch_add(1, std::memory_order_relaxed);
+        uint32_t &count = cache.count[sizeClass];
+        while( count > keep ) {
+          _heap.free(cache.blocks[sizeClass][--count]);
+        }
+      }
+
+      void flush(Cache &cache) {
+        for( uint32_t sizeClass = 0; sizeClass < CLASSES; sizeClass++ ) {
+          if( cache.count[sizeClass] > 0 ) {
+            release(cache, sizeClass, 0);
+          }
+        }
+        cache.owner = nullptr;
+      }
+
+    public:
+      ThreadCachedHeap() :
+              _transfers(0) {
+      }
+
+      ~ThreadCachedHeap() {
+        // the blocks cached on this thread die with the heap; a later heap must start from an empty cache
+        Cache &local = threadCache();
+        if( local.owner == this ) {
+          for( uint32_t sizeClass = 0; sizeClass < CLASSES; sizeClass++ ) {
+            local.count[sizeClass] = 0;
+          }
+          local.owner = nullptr;
+        }
+      }
+
+      ThreadCachedHeap(const ThreadCachedHeap &) = delete;
+      ThreadCachedHeap &operator=(const ThreadCachedHeap &) = delete;
+
+      /**
+       * As SizeClassHeap::allocate, calls logError if the request is too large or its class is exhausted.
+       */
+      uint8_t *allocate(uint32_t size) {
+        const uint32_t sizeClass = HEAP::classFor(size);
+        if( sizeClass == HEAP::NO_CLASS ) {
+          heapError(size);
+          return nullptr;
+        }
+        Cache &local = cache();
+        if( local.count[sizeClass] == 0 ) {
+          refill(local, sizeClass);
+          if( local.count[sizeClass] == 0 ) {
+            heapError(size);
+            return nullptr;
+          }
+        }
+        return local.blocks[sizeClass][--local.count[sizeClass]];
+      }
+
+      void free(uint8_t *pointer) {
+        if( pointer == nullptr ) {
+          return;
+        }
+        const uint32_t sizeClass = _heap.classOf(pointer);
+        if( sizeClass == HEAP::NO_CLASS ) {
+          return;
+        }
+        Cache &local = cache();
+        if( local.count[sizeClass] == CACHE_SIZE ) {
+          release(local, sizeClass, BATCH);
+        }
+        local.blocks[sizeClass][local.count[sizeClass]++] = pointer;
+      }
+
+      /**
+       * Return the calling thread's cached blocks to the heap.
+       */
+      void flush() {
+        Cache &local = cache();
+        flush(local);
+      }
+
+      /**
+       * Blocks of a class not held by any thread or cache.
+       */
+      uint32_t freeSpace(uint32_t sizeClass) {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _heap.freeSpace(sizeClass);
+      }
+
+      /**
+       * Times a cache has gone to the shared heap, a measure of lock traffic.
+       */
+      uint32_t transfers() const {
+        return _transfers.load(std::memory_order_relaxed);
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef INCLUDES_DRIVERS_STEPPER_DUTYCYCLETABLE_HPP_
+#define INCLUDES_DRIVERS_STEPPER_DUTYCYCLETABLE_HPP_
+
+#include <SolexOs/Assert.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <drivers/timers/CycleBudget.hpp>
+#include <drivers/timers/PwmTypes.hpp>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * Precomputed duty cycle surface for a StepperPredictiveModel.
+   *
+   * The model is sampled once at initialisation on a regular grid over (speed, current, target) and the
+   * PWM tick then interpolates the grid instead of solving the coil equations. The table holds the signed
+   * duty (positive channel > 0, negative channel < 0) so the interpolation is smooth through zero.
+   *
+   * With SPEED_STEPS == 1 the table is 2D and the lookup is bilinear (4 reads). Otherwise the lookup is
+   * trilinear (8 reads). Inputs outside the grid are clamped to the edge of the table.
+   */
+  template<typename FP, uint32_t CURRENT_STEPS, uint32_t TARGET_STEPS, uint32_t SPEED_STEPS = 1>
+  class DutyCycleTable {
+    private:
+      static_assert(CURRENT_STEPS >= 2 && TARGET_STEPS >= 2, "Need at least two points on each axis");
+
+      struct Axis {
+          FP min;
+          FP range;
+          FP inverseStep;
+          uint32_t last;
+
+          Axis(FP low, FP high, uint32_t steps) :
+                  min(low),
+                  range(high - low),
+                  inverseStep(inverseStepFor(low, high, steps)),
+                  last(steps > 1 ? steps - 2 : 0) {
+          }
+
+          /**
+           * Grid points per unit. An axis of more than one step over an empty range has none; that calls
+           * logError and, should it return, every value falls in the first cell.
+           */
+          static FP inverseStepFor(FP low, FP high, uint32_t steps) {
+            if( steps <= 1 ) {
+              return FP(0.0);
+            }
+            if( high == low ) {
+              logError(static_cast<Assert::FatalRecoveryOption>(0), static_cast<Assert::FatalErrorCode>(0), steps);
+              return FP(0.0);
+            }
+            return FP(static_cast<int32_t>(steps - 1), 0) / (high - low);
+          }
+
+          /**
+           * Grid point i. Multiplying before dividing keeps the points where locate() expects them.
+           */
+          FP at(uint32_t i) const {
+            return min + range * static_cast<int32_t>(i) / static_cast<int32_t>(last + 1);
+          }
+
+          /**
+           * Split a value into a cell index and the fraction across the cell, clamped to the table.
+           */
+          uint32_t locate(FP value, FP &fraction) const {
+            FP position = (value - min) * inverseStep;
+            if( position < FP(0.0) ) {
+              fraction = FP(0.0);
+              return 0;
+            }
+            int32_t index = position.asInt();
+            if( static_cast<uint32_t>(index) > last ) {
+              fraction = FP(1.0);
+              return last;
+            }
+            fraction = position - FP(index, 0);
+            return static_cast<uint32_t>(index);
+          }
+      };
+
+      Axis _current;
+      Axis _target;
+      Axis _speed;
+      PwmChannel _positiveChannel;
+      PwmChannel _negativeChannel;
+      FP _table[SPEED_STEPS][CURRENT_STEPS][TARGET_STEPS];
+
+      static FP lerp(FP a, FP b, FP fraction) {
+        return a + (b - a) * fraction;
+      }
+
+      FP bilinear(uint32_t s, uint32_t c, uint32_t t, FP fc, FP ft) const {
+        FP low = lerp(_table[s][c][t], _table[s][c][t + 1], ft);
+        FP high = lerp(_table[s][c + 1][t], _table[s][c + 1][t + 1], ft);
+        return lerp(low, high, fc);
+      }
+
+    public:
+      /**
+       * Sample the model over current [minCurrent, maxCurrent], target [minTarget, maxTarget] and speed
+       * [minSpeed, maxSpeed]. Only minSpeed is used for a 2D table.
+       */
+      DutyCycleTable(StepperPredictiveModel<FP> &model, PwmChannel positive, PwmChannel negative,
+          FP minCurrent, FP maxCurrent, FP minTarget, FP maxTarget, FP minSpeed = FP(0.0), FP maxSpeed = FP(0.0)) :
+              _current(minCurrent, maxCurrent, CURRENT_STEPS),
+              _target(minTarget, maxTarget, TARGET_STEPS),
+              _speed(minSpeed, maxSpeed, SPEED_STEPS),
+              _positiveChannel(positive),
+              _negativeChannel(negative) {
+        for( uint32_t s = 0; s < SPEED_STEPS; s++ ) {
+          FP speed = _speed.at(s);
+          for( uint32_t c = 0; c < CURRENT_STEPS; c++ ) {
+            FP current = _current.at(c);
+            for( uint32_t t = 0; t < TARGET_STEPS; t++ ) {
+              FP target = _target.at(t);
+              DutyCycle duty = model.computeDutyCycle(speed, target, current);
+              int32_t value = (duty.channel == _negativeChannel) ? -static_cast<int32_t>(duty.duty) : duty.duty;
+              _table[s][c][t] = FP(value, 0);
+            }
+          }
+        }
+      }
+
+      /**
+       * Same interface as StepperPredictiveModel::computeDutyCycle.
+       */
+      DutyCycle computeDutyCycle(FP speed, FP target, FP current) const {
+        CYCLE_BUDGET_SCOPE("DutyCycleTable::computeDutyCycle");
+        FP fc;
+        FP ft;
+        uint32_t c = _current.locate(current, fc);
+        uint32_t t = _target.locate(target, ft);
+        FP value;
+        if constexpr (SPEED_STEPS == 1) {
+          (void) speed;
+          value = bilinear(0, c, t, fc, ft);
+        } else {
+          FP fs;
+          uint32_t s = _speed.locate(speed, fs);
+          value = lerp(bilinear(s, c, t, fc, ft), bilinear(s + 1, c, t, fc, ft), fs);
+        }
+        int32_t duty = (value + FP(0.5)).asInt();
+        if( duty < 0 ) {
+          return DutyCycle(static_cast<uint16_t>(-duty), _negativeChannel);
+        }
+        return DutyCycle(static_cast<uint16_t>(duty), _positiveChannel);
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef INCLUDES_DRIVERS_STEPPER_MULTIAXISCONTROLLER_HPP_
+#define INCLUDES_DRIVERS_STEPPER_MULTIAXISCONTROLLER_HPP_
+
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <drivers/timers/CycleBudget.hpp>
+#include <drivers/timers/PwmTypes.hpp>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * Current controller for several axes driven by the same kind of motor, updated together once per PWM tick.
+   *
+   * Each axis computes the same thing as a RuntimePidController feeding a StepperPredictiveModel. The
+   * controller history is held as one array per field rather than one object per axis, so the PID pass is a
+   * single loop over the axes with the gains and limits loaded once. The duty cycles are then computed in a
+   * second pass through the shared model, which may be a StepperPredictiveModel or a DutyCycleTable.
+   */
+  template<typename T, uint32_t AXES, typename MODEL = StepperPredictiveModel<T>>
+  class MultiAxisController {
+    private:
+      static_assert(AXES > 0, "Need at least one axis");
+
+      MODEL &_model;
+      PidTuning<T> _tuning;
+      T _integral[AXES];
+      T _lastError[AXES];
+      T _correction[AXES];
+
+      void updatePid(const T *target, const T *current) {
+        const T kp = _tuning.Kp;
+        const T ki = _tuning.Ki;
+        const T kd = _tuning.Kd;
+        const T maxIntegral = _tuning.maxIntegral;
+        const T minIntegral = -_tuning.maxIntegral;
+        const T maxOutput = _tuning.maxOutput;
+        const T minOutput = _tuning.minOutput;
+        for( uint32_t axis = 0; axis < AXES; axis++ ) {
+          T error = current[axis] - target[axis];
+          T integral = _integral[axis] + error;
+          integral = (integral > maxIntegral) ? maxIntegral : ((integral < minIntegral) ? minIntegral : integral);
+          T output = kp * error + ki * integral + kd * (error - _lastError[axis]);
+          _integral[axis] = integral;
+          _lastError[axis] = error;
+          _correction[axis] = (output > maxOutput) ? maxOutput : ((output < minOutput) ? minOutput : output);
+        }
+      }
+
+    public:
+      MultiAxisController(MODEL &model, const PidTuning<T> &tuning) :
+              _model(model),
+              _tuning(tuning) {
+        reset();
+      }
+
+      static constexpr uint32_t axes() {
+        return AXES;
+      }
+
+      void setTuning(const PidTuning<T> &tuning) {
+        _tuning = tuning;
+      }
+
+      const PidTuning<T> &getTuning() const {
+        return _tuning;
+      }
+
+      void reset() {
+        for( uint32_t axis = 0; axis < AXES; axis++ ) {
+          reset(axis);
+        }
+      }
+
+      /**
+       * Return the history of one axis to the reset values of the tuning, e.g. when it is enabled.
+       */
+      void reset(uint32_t axis) {
+        _integral[axis] = _tuning.resetIntegral;
+        _lastError[axis] = _tuning.resetError;
+        _correction[axis] = T(0.0);
+      }
+
+      /**
+       * The PID correction applied to the target of an axis on the last update.
+       */
+      T correction(uint32_t axis) const {
+        return _correction[axis];
+      }
+
+      /**
+       * Update every axis for one tick.
+       *
+       * @param speed estimated speed of each axis
+       * @param target the current each axis should reach by the end of the tick
+       * @param current the measured current of each axis
+       * @param duty receives the duty cycle for each axis
+       */
+      void update(const T *speed, const T *target, const T *current, DutyCycle *duty) {
+        CYCLE_BUDGET_SCOPE("MultiAxisController::update");
+        updatePid(target, current);
+        for( uint32_t axis = 0; axis < AXES; axis++ ) {
+          duty[axis] = _model.computeDutyCycle(speed[axis], target[axis] + _correction[axis], current[axis]);
+        }
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef INCLUDES_DRIVERS_STEPPER_RUNTIMEPIDCONTROLLER_HPP_
+#define INCLUDES_DRIVERS_STEPPER_RUNTIMEPIDCONTROLLER_HPP_
+
+#include <drivers/timers/CycleBudget.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * PID tuning held as data so it can be changed without rebuilding, e.g. from a configuration message.
+   * Field meanings match the static members of the PidController parameter types. RESET_VALUE_SETPOINT has
+   * no field: the runtime controllers take the set point on every call and keep no set point history.
+   */
+  template<typename T>
+  struct PidTuning {
+      T Kp;
+      T Ki;
+      T Kd;
+      T maxOutput;
+      T minOutput;
+      T maxIntegral;
+      T resetError;
+      T resetIntegral;
+
+      /**
+       * The tuning from a compile time parameter type as used by PidController.
+       */
+      template<typename Params>
+      static constexpr PidTuning fromParameters() {
+        return {T(Params::Kp), T(Params::Ki), T(Params::Kd), T(Params::MAX_OUTPUT_VALUE), T(Params::MIN_OUTPUT_VALUE),
+          T(Params::MAX_INTEGRAL), T(Params::RESET_VALUE_ERROR), T(Params::RESET_VALUE_INTEGRAL)};
+      }
+
+      template<typename STREAM> inline bool read(STREAM &stream) {
+        if( stream.bytesLeft() < streamSize() ) {
+          return false;
+        }
+        stream.read(Kp);
+        stream.read(Ki);
+        stream.read(Kd);
+        stream.read(maxOutput);
+        stream.read(minOutput);
+        stream.read(maxIntegral);
+        stream.read(resetError);
+        stream.read(resetIntegral);
+        return true;
+      }
+
+      template<typename STREAM> inline void write(STREAM &stream) const {
+        stream.write(Kp);
+        stream.write(Ki);
+        stream.write(Kd);
+        stream.write(maxOutput);
+        stream.write(minOutput);
+        stream.write(maxIntegral);
+        stream.write(resetError);
+        stream.write(resetIntegral);
+      }
+
+      static constexpr size_t streamSize() {
+        return 8 * sizeof(T);
+      }
+  };
+
+  /**
+   * PID controller with the gains loaded at runtime.
+   *
+   * The tuning is copied into the controller rather than referenced so computeOutput reads it from the same
+   * object as the controller state and the compiler can keep it in registers across a loop, giving the same
+   * inner loop as a controller whose gains are compile time constants.
+   */
+  template<typename T>
+  class RuntimePidController {
+    private:
+      PidTuning<T> _tuning;
+      T _integral;
+      T _lastError;
+
+    public:
+      explicit RuntimePidController(const PidTuning<T> &tuning) :
+              _tuning(tuning),
+              _integral(tuning.resetIntegral),
+              _lastError(tuning.resetError) {
+      }
+
+      /**
+       * Change the tuning. The controller history is kept so this can be done while running.
+       */
+      void setTuning(const PidTuning<T> &tuning) {
+        _tuning = tuning;
+      }
+
+      const PidTuning<T> &getTuning() const {
+        return _tuning;
+      }
+
+      /**
+       * Return the history to the reset values of the tuning.
+       */
+      void reset() {
+        _integral = _tuning.resetIntegral;
+        _lastError = _tuning.resetError;
+      }
+
+      /**
+       * Correction to apply to the set point for the measured value.
+       */
+      T computeOutput(T current, T setPoint) {
+        CYCLE_BUDGET_SCOPE("RuntimePidController::computeOutput");
+        T error = current - setPoint;
+        _integral = _integral + error;
+        if( _integral > _tuning.maxIntegral ) {
+          _integral = _tuning.maxIntegral;
+        } else if( _integral < -_tuning.maxIntegral ) {
+          _integral = -_tuning.maxIntegral;
+        }
+        T output = _tuning.Kp * error + _tuning.Ki * _integral + _tuning.Kd * (error - _lastError);
+        _lastError = error;
+        if( output > _tuning.maxOutput ) {
+          return _tuning.maxOutput;
+        }
+        if( output < _tuning.minOutput ) {
+          return _tuning.minOutput;
+        }
+        return output;
+      }
+  };
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef INCLUDES_DRIVERS_STEPPER_SPEEDOBSERVER_HPP_
+#define INCLUDES_DRIVERS_STEPPER_SPEEDOBSERVER_HPP_
+
+#include <drivers/timers/PwmTypes.hpp>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * Estimates the speed (and so the back emf k*speed) of a coil from how far the measured current
+   * lands from where a plant model predicted it would.
+   *
+   * Each tick the observer predicts the current at the end of the tick from the measured current, the duty
+   * cycle applied and the speed estimate. The current at the end of a cycle is linear in the speed, so
+   * predicting at the estimate and at the estimate plus one gives the slope, and the residual divided by the
+   * slope is the speed error. A fraction (the gain) of that is applied each tick to filter measurement
+   * noise. While the duty makes the current insensitive to speed the slope is too small to trust and the
+   * estimate is held.
+   *
+   * PLANT is anything with computeCurrentAtEndOfCycle(speed, current, duty), normally a cached
+   * StepperPlantModel in the same number type so the whole estimate runs in fixed point.
+   *
+   * Use once per tick:
+   *   observer.correct(measured);
+   *   duty = model.computeDutyCycle(observer.speed(), target, measured);
+   *   observer.predict(measured, duty);
+   */
+  template<typename T, typename PLANT>
+  class SpeedObserver {
+    private:
+      PLANT &_plant;
+      uint32_t _cyclesPerTick;
+      T _gain;
+      T _minimumSlope;
+
+      T _speed;
+      T _predicted;
+      T _slope;
+      bool _hasPrediction;
+
+      T endOfTick(T speed, T current, DutyCycle duty) {
+        for( uint32_t cycle = 0; cycle < _cyclesPerTick; cycle++ ) {
+          current = _plant.computeCurrentAtEndOfCycle(speed, current, duty);
+        }
+        return current;
+      }
+
+    public:
+      /**
+       * @param plant predicts the current over one PWM cycle
+       * @param cyclesPerTick PWM cycles between measurements
+       * @param gain fraction of the speed error corrected each tick, 0 < gain <= 1
+       * @param minimumSlope smallest change in current per unit speed over a tick that is used to correct
+       */
+      SpeedObserver(PLANT &plant, uint32_t cyclesPerTick, T gain, T minimumSlope, T initialSpeed = T(0.0)) :
+              _plant(plant),
+              _cyclesPerTick(cyclesPerTick),
+              _gain(gain),
+              _minimumSlope(minimumSlope),
+              _speed(initialSpeed),
+              _predicted(0.0),
+              _slope(0.0),
+              _hasPrediction(false) {
+      }
+
+      void reset(T speed = T(0.0)) {
+        _speed = speed;
+        _hasPrediction = false;
+      }
+
+      T speed() const {
+        return _speed;
+      }
+
+      /**
+       * Update the estimate from the current measured at the end of the tick that was last predicted.
+       */
+      void correct(T measured) {
+        if( !_hasPrediction ) {
+          return;
+        }
+        if( _slope > _minimumSlope || _slope < -_minimumSlope ) {
+          _speed = _speed + _gain * (measured - _predicted) / _slope;
+        }
+        _hasPrediction = false;
+      }
+
+      /**
+       * Predict the current at the end of the coming tick for the duty cycle about to be applied.
+       */
+      void predict(T current, DutyCycle duty) {
+        _predicted = endOfTick(_speed, current, duty);
+        _slope = endOfTick(_speed + T(1.0), current, duty) - _predicted;
+        _hasPrediction = true;
+      }
+  };
+
+}
+
+#endif
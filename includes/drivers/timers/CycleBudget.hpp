@@ -0,0 +1,254 @@
+#ifndef INCLUDES_DRIVERS_TIMERS_CYCLEBUDGET_HPP_
+#define INCLUDES_DRIVERS_TIMERS_CYCLEBUDGET_HPP_
+
+/**
+ * Optional timing of the control loop hot spots.
+ *
+ * Build with CYCLE_BUDGET defined to time every CYCLE_BUDGET_SCOPE site. Without it the macro expands to a
+ * no-op and none of this is referenced by the instrumented code. The switch changes the inline functions of
+ * every instrumented header, so it must be set for the whole build (the opt-in CycleBudget configuration
+ * defines it) and never in a source file, or translation units would disagree on their definitions.
+ *
+ * The statistics are not atomic; time a single threaded run. PidGainTunerTest drops to one tuner thread
+ * when CYCLE_BUDGET is defined for this reason.
+ */
+
+#include <cstdint>
+
+#ifdef CYCLE_BUDGET
+#include <SolexOs/Debug.h>
+#endif
+
+#if defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define CYCLE_COUNTER_DWT
+#elif defined(CYCLE_BUDGET)
+#error "CYCLE_BUDGET needs the DWT cycle counter of ARMv7-M or ARMv8-M mainline"
+#endif
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace Drivers {
+
+  /**
+   * Free running cycle count. DWT CYCCNT on Cortex-M, the time stamp counter on x86 hosts and nanoseconds
+   * on other hosts. Only differences between two reads are meaningful and they wrap at 32 bits. Cortex-M
+   * parts without a DWT cycle counter read 0.
+   */
+  struct CycleCounter {
+#if defined(CYCLE_COUNTER_DWT)
+      static constexpr uintptr_t DEMCR = 0xE000EDFC;
+      static constexpr uintptr_t DWT_CTRL = 0xE0001000;
+      static constexpr uintptr_t DWT_CYCCNT = 0xE0001004;
+      static constexpr uint32_t DEMCR_TRCENA = 1u << 24;
+      static constexpr uint32_t DWT_CTRL_CYCCNTENA = 1u << 0;
+
+      static void enable() {
+        *reinterpret_cast<volatile uint32_t *>(DEMCR) |= DEMCR_TRCENA;
+        *reinterpret_cast<volatile uint32_t *>(DWT_CYCCNT) = 0;
+        *reinterpret_cast<volatile uint32_t *>(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+      }
+
+      static uint32_t now() {
+        return *reinterpret_cast<volatile uint32_t *>(DWT_CYCCNT);
+      }
+#elif defined(__ARM_ARCH_PROFILE) && (__ARM_ARCH_PROFILE == 'M')
+      static void enable() {
+      }
+
+      static uint32_t now() {
+        return 0;
+      }
+#elif defined(__x86_64__) || defined(__i386__)
+      static void enable() {
+      }
+
+      static uint32_t now() {
+        return static_cast<uint32_t>(__rdtsc());
+      }
+#else
+      static void enable() {
+      }
+
+      static uint32_t now() {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+      }
+#endif
+  };
+
+  /**
+   * Timing statistics for one call site: min, mean and max cycles and a histogram with power of two bins
+   * (bin n counts calls taking [2^n, 2^(n+1)) cycles, the last bin everything longer).
+   *
+   * Every budget links itself into a list when constructed so reportAll() can dump them together.
+   */
+  class CycleBudget {
+    public:
+      static constexpr uint32_t BINS = 16;
+
+    private:
+      static constexpr uint32_t TRACE_MODULE = 0;
+      static constexpr uint32_t TRACE_LEVEL = 0;
+
+      const char *_name;
+      CycleBudget *_next;
+      uint32_t _min;
+      uint32_t _max;
+      uint64_t _total;
+      uint32_t _count;
+      uint32_t _histogram[BINS];
+
+      static CycleBudget *&head() {
+        static CycleBudget *first = nullptr;
+        return first;
+      }
+
+      static uint32_t binOf(uint32_t cycles) {
+        uint32_t bin = 0;
+        while( (cycles >>= 1) != 0 && bin < BINS - 1 ) {
+          bin++;
+        }
+        return bin;
+      }
+
+#ifdef CYCLE_BUDGET
+      static void sendNumber(uint32_t value) {
+        DBG_Space(TRACE_MODULE, TRACE_LEVEL);
+        DBG_SendNumber(TRACE_MODULE, TRACE_LEVEL, sizeof(value), value);
+      }
+#endif
+
+    public:
+      explicit CycleBudget(const char *name) :
+              _name(name),
+              _next(head()) {
+        reset();
+        head() = this;
+      }
+
+      ~CycleBudget() {
+        for( CycleBudget **link = &head(); *link != nullptr; link = &(*link)->_next ) {
+          if( *link == this ) {
+            *link = _next;
+            break;
+          }
+        }
+      }
+
+      CycleBudget(const CycleBudget &) = delete;
+      CycleBudget &operator=(const CycleBudget &) = delete;
+
+      void reset() {
+        _min = UINT32_MAX;
+        _max = 0;
+        _total = 0;
+        _count = 0;
+        for( auto &bin : _histogram ) {
+          bin = 0;
+        }
+      }
+
+      void record(uint32_t cycles) {
+        if( cycles < _min ) {
+          _min = cycles;
+        }
+        if( cycles > _max ) {
+          _max = cycles;
+        }
+        _total += cycles;
+        _count++;
+        _histogram[binOf(cycles)]++;
+      }
+
+      const char *name() const {
+        return _name;
+      }
+
+      uint32_t count() const {
+        return _count;
+      }
+
+      uint32_t min() const {
+        return _count ? _min : 0;
+      }
+
+      uint32_t max() const {
+        return _max;
+      }
+
+      uint32_t mean() const {
+        return _count ? static_cast<uint32_t>(_total / _count) : 0;
+      }
+
+      uint32_t bin(uint32_t index) const {
+        return _histogram[index];
+      }
+
+#ifdef CYCLE_BUDGET
+      /**
+       * Send "name count min mean max bin0 .. bin15" in hex on one line. Only built with CYCLE_BUDGET so
+       * uninstrumented builds do not need the debug output.
+       */
+      void report() const {
+        DBG_SendRawString(TRACE_MODULE, TRACE_LEVEL, _name);
+        sendNumber(_count);
+        sendNumber(min());
+        sendNumber(mean());
+        sendNumber(_max);
+        for( auto bin : _histogram ) {
+          sendNumber(bin);
+        }
+        DBG_SendRawString(TRACE_MODULE, TRACE_LEVEL, "\n");
+      }
+
+      static void reportAll() {
+        for( const CycleBudget *budget = head(); budget != nullptr; budget = budget->_next ) {
+          budget->report();
+        }
+      }
+#endif
+
+      static void resetAll() {
+        for( CycleBudget *budget = head(); budget != nullptr; budget = budget->_next ) {
+          budget->reset();
+        }
+      }
+  };
+
+  /**
+   * Records the cycles from construction to destruction against a budget.
+   */
+  class CycleBudgetScope {
+    private:
+      CycleBudget &_budget;
+      uint32_t _start;
+
+    public:
+      explicit CycleBudgetScope(CycleBudget &budget) :
+              _budget(budget),
+              _start(CycleCounter::now()) {
+      }
+
+      ~CycleBudgetScope() {
+        _budget.record(CycleCounter::now() - _start);
+      }
+
+      CycleBudgetScope(const CycleBudgetScope &) = delete;
+      CycleBudgetScope &operator=(const CycleBudgetScope &) = delete;
+  };
+
+}
+
+#ifdef CYCLE_BUDGET
+#define CYCLE_BUDGET_SCOPE(NAME) \
+  static Drivers::CycleBudget cycleBudget_(NAME); \
+  Drivers::CycleBudgetScope cycleBudgetScope_(cycleBudget_)
+#else
+#define CYCLE_BUDGET_SCOPE(NAME) static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef INCLUDES_NUMERIC_FIXEDPOINTTRAITS_HPP_
+#define INCLUDES_NUMERIC_FIXEDPOINTTRAITS_HPP_
+
+#include <numeric/FixedPoint.hpp>
+#include <cstdint>
+
+namespace numeric {
+
+  /**
+   * Number of fraction bits in a fixed point type.
+   */
+  template<typename T>
+  struct FractionBits;
+
+  template<auto FRACTION, typename S>
+  struct FractionBits<FixedPoint<FRACTION, S>> {
+      static constexpr int32_t value = static_cast<int32_t>(FRACTION);
+  };
+
+  /**
+   * Build a fixed point value from a raw integer that has RAW_FRACTION fraction bits.
+   */
+  template<typename FP, int32_t RAW_FRACTION>
+  constexpr FP fromRaw(int32_t raw) {
+    constexpr int32_t SHIFT = FractionBits<FP>::value - RAW_FRACTION;
+    if constexpr (SHIFT >= 0) {
+      return FP(0, raw * (1 << SHIFT));
+    } else {
+      return FP(0, raw >> -SHIFT);
+    }
+  }
+}
+
+#endif
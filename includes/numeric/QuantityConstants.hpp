@@ -0,0 +1,89 @@
+#ifndef INCLUDES_NUMERIC_QUANTITYCONSTANTS_HPP_
+#define INCLUDES_NUMERIC_QUANTITYCONSTANTS_HPP_
+
+#include <numeric/Quantity.hpp>
+#include <numeric/Units.hpp>
+#include <utility>
+
+namespace numeric {
+  namespace SI {
+
+    using Dimensionless = Unit<0, 0, 0, 0>;
+
+    /**
+     * A scalar that has already been converted to the number type of the quantity.
+     *
+     * Multiplying a quantity by a double converts the double every time the expression is evaluated.
+     * Declaring the scalar as a constexpr Constant moves that conversion to compile time so the hot path
+     * is only the FixedPoint operation:
+     *
+     *   constexpr auto GAIN = Constant<FP>(2.5);
+     *   auto e = v * GAIN;
+     */
+    template<typename V>
+    struct Constant {
+        V value;
+
+        constexpr explicit Constant(double d) :
+                value(d) {
+        }
+    };
+
+    /**
+     * A scalar divisor stored as its reciprocal so q / d becomes a single multiply. The result
+     * can differ from a true division in the last bit.
+     */
+    template<typename V>
+    struct Reciprocal {
+        V value;
+
+        constexpr explicit Reciprocal(double d) :
+                value(1.0 / d) {
+        }
+    };
+
+    template<typename U, typename V>
+    constexpr Quantity<U, V> operator*(const Quantity<U, V> &q, const Constant<V> &c) {
+      return Quantity<U, V>(q.value * c.value);
+    }
+
+    template<typename U, typename V>
+    constexpr Quantity<U, V> operator*(const Constant<V> &c, const Quantity<U, V> &q) {
+      return Quantity<U, V>(c.value * q.value);
+    }
+
+    template<typename U, typename V>
+    constexpr Quantity<U, V> operator/(const Quantity<U, V> &q, const Constant<V> &c) {
+      return Quantity<U, V>(q.value / c.value);
+    }
+
+    template<typename U, typename V>
+    constexpr Quantity<U, V> operator/(const Quantity<U, V> &q, const Reciprocal<V> &r) {
+      return Quantity<U, V>(q.value * r.value);
+    }
+
+    /**
+     * c / q has the inverse unit of q.
+     */
+    template<typename U, typename V>
+    constexpr auto operator/(const Constant<V> &c, const Quantity<U, V> &q)
+        -> decltype(std::declval<Quantity<Dimensionless, V>>() / q) {
+      return Quantity<Dimensionless, V>(c.value) / q;
+    }
+
+    namespace FixedPoint {
+      /**
+       * Literal for a scalar constant in the default fixed point format. e.g. v * 2.5_k
+       */
+      constexpr Constant<FP> operator"" _k(long double d) {
+        return Constant<FP>(static_cast<double>(d));
+      }
+
+      constexpr Reciprocal<FP> operator"" _inv(long double d) {
+        return Reciprocal<FP>(static_cast<double>(d));
+      }
+    }
+  }
+}
+
+#endif
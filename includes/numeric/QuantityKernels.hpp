@@ -0,0 +1,76 @@
+#ifndef INCLUDES_NUMERIC_QUANTITYKERNELS_HPP_
+#define INCLUDES_NUMERIC_QUANTITYKERNELS_HPP_
+
+#include <numeric/Quantity.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace numeric {
+  namespace SI {
+
+    /**
+     * Block kernels over arrays of quantities.
+     *
+     * A Quantity is only a unit tag wrapped around its value so an array of quantities has exactly
+     * the same layout as an array of the underlying numbers. These kernels work directly on the
+     * wrapped value so the loops are the same as the ones over the raw type and the compiler is free
+     * to unroll and vectorise them, while the unit checks still happen at the call site.
+     */
+    template<typename Q>
+    struct QuantityLayout;
+
+    template<typename U, typename V>
+    struct QuantityLayout<Quantity<U, V>> {
+        static constexpr bool isZeroOverhead = sizeof(Quantity<U, V>) == sizeof(V)
+            && alignof(Quantity<U, V>) == alignof(V)
+            && std::is_trivially_copyable<Quantity<U, V>>::value;
+    };
+
+    /**
+     * out[i] = in[i] * factor
+     */
+    template<typename U, typename V>
+    inline void scale(Quantity<U, V> *out, const Quantity<U, V> *in, const V factor, uint32_t count) {
+      static_assert(QuantityLayout<Quantity<U, V>>::isZeroOverhead, "Quantity must be a zero overhead wrapper");
+      for( uint32_t i = 0; i < count; i++ ) {
+        out[i].value = in[i].value * factor;
+      }
+    }
+
+    /**
+     * out[i] = out[i] + in[i] * factor
+     */
+    template<typename U, typename V>
+    inline void multiplyAccumulate(Quantity<U, V> *out, const Quantity<U, V> *in, const V factor, uint32_t count) {
+      static_assert(QuantityLayout<Quantity<U, V>>::isZeroOverhead, "Quantity must be a zero overhead wrapper");
+      for( uint32_t i = 0; i < count; i++ ) {
+        out[i].value = out[i].value + in[i].value * factor;
+      }
+    }
+
+    /**
+     * out[i] = a[i] * b[i] with the unit of the result derived from the operands.
+     */
+    template<typename UA, typename UB, typename V>
+    inline void multiply(decltype(std::declval<Quantity<UA, V>>() * std::declval<Quantity<UB, V>>()) *out,
+        const Quantity<UA, V> *a, const Quantity<UB, V> *b, uint32_t count) {
+      for( uint32_t i = 0; i < count; i++ ) {
+        out[i] = a[i] * b[i];
+      }
+    }
+
+    /**
+     * out[i] = a[i] / b[i] with the unit of the result derived from the operands.
+     */
+    template<typename UA, typename UB, typename V>
+    inline void divide(decltype(std::declval<Quantity<UA, V>>() / std::declval<Quantity<UB, V>>()) *out,
+        const Quantity<UA, V> *a, const Quantity<UB, V> *b, uint32_t count) {
+      for( uint32_t i = 0; i < count; i++ ) {
+        out[i] = a[i] / b[i];
+      }
+    }
+  }
+}
+
+#endif
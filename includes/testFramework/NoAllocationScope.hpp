@@ -0,0 +1,68 @@
+#ifndef INCLUDES_TESTFRAMEWORK_NOALLOCATIONSCOPE_HPP_
+#define INCLUDES_TESTFRAMEWORK_NOALLOCATIONSCOPE_HPP_
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+/**
+ * Counts of heap operations made by the current thread since it started.
+ *
+ * SmallHeap calls are counted by wrapping memory::allocateSmallBlock and memory::freeSmallBlock at link time
+ * (see allocationCounter.cpp for the linker flags), global new and delete by replacing them.
+ */
+struct AllocationCounts {
+    uint32_t smallAllocations;
+    uint32_t smallFrees;
+    uint32_t newCalls;
+    uint32_t deleteCalls;
+
+    uint32_t total() const {
+      return smallAllocations + smallFrees + newCalls + deleteCalls;
+    }
+
+    AllocationCounts operator-(const AllocationCounts &rhs) const {
+      return {smallAllocations - rhs.smallAllocations, smallFrees - rhs.smallFrees, newCalls - rhs.newCalls,
+        deleteCalls - rhs.deleteCalls};
+    }
+};
+
+AllocationCounts allocationCounts();
+
+/**
+ * Fails the test if anything in its scope allocates or frees, even if the heap is balanced at the end
+ * which checkForLeaks() would accept.
+ *
+ *   {
+ *     NoAllocationScope noAllocation;
+ *     msg.decode(a, b, c);
+ *   }
+ */
+class NoAllocationScope {
+  private:
+    AllocationCounts _start;
+
+  public:
+    NoAllocationScope() :
+            _start(allocationCounts()) {
+    }
+
+    NoAllocationScope(const NoAllocationScope &) = delete;
+    NoAllocationScope &operator=(const NoAllocationScope &) = delete;
+
+    /**
+     * Operations since the scope started.
+     */
+    AllocationCounts counts() const {
+      return allocationCounts() - _start;
+    }
+
+    ~NoAllocationScope() {
+      AllocationCounts made = counts();
+      EXPECT_EQ(made.smallAllocations, 0u) << "allocateSmallBlock called in a NoAllocationScope";
+      EXPECT_EQ(made.smallFrees, 0u) << "freeSmallBlock called in a NoAllocationScope";
+      EXPECT_EQ(made.newCalls, 0u) << "operator new called in a NoAllocationScope";
+      EXPECT_EQ(made.deleteCalls, 0u) << "operator delete called in a NoAllocationScope";
+    }
+};
+
+#endif
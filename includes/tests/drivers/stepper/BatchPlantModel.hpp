@@ -0,0 +1,196 @@
+#ifndef INCLUDES_TESTS_DRIVERS_STEPPER_BATCHPLANTMODEL_HPP_
+#define INCLUDES_TESTS_DRIVERS_STEPPER_BATCHPLANTMODEL_HPP_
+
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <drivers/timers/PwmTypes.hpp>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace Drivers {
+
+  /**
+   * Coil parameters for one instance of a batch plant.
+   */
+  struct PlantParameters {
+      double V;
+      double R;
+      double L;
+      double k;
+  };
+
+  /**
+   * Structure of arrays version of StepperPlantModel<double> in CACHED mode that advances many plants
+   * (e.g. the R/L/V variations used to tune the PID gains) in one call.
+   *
+   * Each field is stored contiguously so the per cycle recurrence runs across instances in SIMD lanes. The
+   * decay factors for each instance's duty are gathered first, then the recurrence runs with the instance
+   * loop innermost. It is cloned for AVX2 and selected at load time so the host uses 4 lanes of doubles
+   * where it can.
+   * Duty cycles are passed signed: positive for the positive channel, negative for the negative channel.
+   *
+   * Each instance also tracks the RMS and maximum error against the targets passed to recordError.
+   */
+  class BatchStepperPlantModel {
+    private:
+      uint32_t _count;
+      PwmChannel _positiveChannel;
+      PwmChannel _negativeChannel;
+
+      std::vector<double> _v;
+      std::vector<double> _k;
+      std::vector<double> _inverseR;
+      // decay factors indexed [duty * count + instance]
+      std::vector<double> _onDecay;
+      std::vector<double> _offDecay;
+
+      std::vector<double> _current;
+      std::vector<double> _errorSquared;
+      std::vector<double> _maxError;
+      uint32_t _samples;
+
+      // per instance values for the current advance, gathered from the tables before the recurrence
+      std::vector<double> _sign;
+      std::vector<double> _aOn;
+      std::vector<double> _aOff;
+      std::vector<double> _iInf;
+      std::vector<double> _value;
+      int32_t _ticks;
+
+      /**
+       * The recurrence over every instance for the given cycles. The instance loop is innermost and has no
+       * branches or table lookups so it vectorises; -fopt-info-vec reports it vectorised for both clones.
+       */
+      __attribute__((target_clones("avx2", "default")))
+      __attribute__((optimize("-O3")))
+      static void recurrence(double * __restrict value, const double * __restrict aOn,
+          const double * __restrict aOff, const double * __restrict iInf, uint32_t count, uint32_t cycles) {
+        for( uint32_t c = 0; c < cycles; c++ ) {
+          for( uint32_t i = 0; i < count; i++ ) {
+            const double peak = iInf[i] + (value[i] - iInf[i]) * aOn[i];
+            value[i] = -iInf[i] + (peak + iInf[i]) * aOff[i];
+          }
+        }
+      }
+
+    public:
+      BatchStepperPlantModel(const std::vector<PlantParameters> &parameters, double period, PwmChannel positive,
+          PwmChannel negative, int32_t ticks) :
+              _count(static_cast<uint32_t>(parameters.size())),
+              _positiveChannel(positive),
+              _negativeChannel(negative),
+              _onDecay(static_cast<size_t>(ticks + 1) * parameters.size()),
+              _offDecay(static_cast<size_t>(ticks + 1) * parameters.size()),
+              _current(parameters.size(), 0.0),
+              _errorSquared(parameters.size(), 0.0),
+              _maxError(parameters.size(), 0.0),
+              _samples(0),
+              _sign(parameters.size()),
+              _aOn(parameters.size()),
+              _aOff(parameters.size()),
+              _iInf(parameters.size()),
+              _value(parameters.size()),
+              _ticks(ticks) {
+        for( const auto &p : parameters ) {
+          _v.push_back(p.V);
+          _k.push_back(p.k);
+          _inverseR.push_back(1.0 / p.R);
+        }
+        for( int32_t duty = 0; duty <= ticks; duty++ ) {
+          double ton = period * duty / ticks;
+          double toff = period * (ticks - duty) / ticks;
+          for( uint32_t i = 0; i < _count; i++ ) {
+            _onDecay[duty * _count + i] = std::exp(-parameters[i].R / parameters[i].L * ton);
+            _offDecay[duty * _count + i] = std::exp(-parameters[i].R / parameters[i].L * toff);
+          }
+        }
+      }
+
+      uint32_t size() const {
+        return _count;
+      }
+
+      double current(uint32_t instance) const {
+        return _current[instance];
+      }
+
+      const double *currents() const {
+        return _current.data();
+      }
+
+      void reset(double initialCurrent) {
+        for( uint32_t i = 0; i < _count; i++ ) {
+          _current[i] = initialCurrent;
+        }
+        resetErrors();
+      }
+
+      void resetErrors() {
+        for( uint32_t i = 0; i < _count; i++ ) {
+          _errorSquared[i] = 0.0;
+          _maxError[i] = 0.0;
+        }
+        _samples = 0;
+      }
+
+      /**
+       * Convert a duty cycle to the signed form used by advance().
+       */
+      int32_t signedDuty(DutyCycle duty) const {
+        return (duty.channel == _negativeChannel) ? -static_cast<int32_t>(duty.duty) : duty.duty;
+      }
+
+      DutyCycle toDutyCycle(int32_t duty) const {
+        return (duty < 0) ? DutyCycle(static_cast<uint16_t>(-duty), _negativeChannel)
+                          : DutyCycle(static_cast<uint16_t>(duty), _positiveChannel);
+      }
+
+      /**
+       * Run every instance for the given number of PWM cycles with its own speed and signed duty. A duty
+       * outside -ticks..ticks throws std::out_of_range.
+       */
+      void advance(const double *speed, const int32_t *duty, uint32_t cycles = 1) {
+        for( uint32_t i = 0; i < _count; i++ ) {
+          if( duty[i] < -_ticks || duty[i] > _ticks ) {
+            throw std::out_of_range("duty outside the decay tables");
+          }
+          const uint32_t index = static_cast<uint32_t>(duty[i] < 0 ? -duty[i] : duty[i]) * _count + i;
+          _sign[i] = duty[i] < 0 ? -1.0 : 1.0;
+          _aOn[i] = _onDecay[index];
+          _aOff[i] = _offDecay[index];
+          _iInf[i] = (_v[i] - _k[i] * speed[i]) * _inverseR[i];
+          _value[i] = _current[i] * _sign[i];
+        }
+        recurrence(_value.data(), _aOn.data(), _aOff.data(), _iInf.data(), _count, cycles);
+        for( uint32_t i = 0; i < _count; i++ ) {
+          _current[i] = _value[i] * _sign[i];
+        }
+      }
+
+      /**
+       * Accumulate the error between each instance's current and its target.
+       */
+      void recordError(const double *target) {
+        for( uint32_t i = 0; i < _count; i++ ) {
+          double delta = std::fabs(target[i] - _current[i]);
+          _errorSquared[i] += delta * delta;
+          if( delta > _maxError[i] ) {
+            _maxError[i] = delta;
+          }
+        }
+        _samples++;
+      }
+
+      double rmsError(uint32_t instance) const {
+        return _samples ? std::sqrt(_errorSquared[instance] / _samples) : 0.0;
+      }
+
+      double maxError(uint32_t instance) const {
+        return _maxError[instance];
+      }
+  };
+
+}
+
+#endif
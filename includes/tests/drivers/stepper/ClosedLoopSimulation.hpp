@@ -0,0 +1,356 @@
+#ifndef INCLUDES_TESTS_DRIVERS_STEPPER_CLOSEDLOOPSIMULATION_HPP_
+#define INCLUDES_TESTS_DRIVERS_STEPPER_CLOSEDLOOPSIMULATION_HPP_
+
+#include <drivers/timers/PwmTypes.hpp>
+#include <SolexOs/Assert.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+namespace Drivers {
+
+  /**
+   * One recorded control tick.
+   */
+  struct SimulationSample {
+      uint64_t tick;
+      double target;
+      double current;
+      double correction;
+      double speed;
+      // positive for the positive channel, negative for the negative channel
+      int32_t duty;
+  };
+
+  struct SimulationConfig {
+      // PWM cycles the plant runs for each control tick
+      uint32_t plantCyclesPerTick;
+      // record every Nth tick to the trace, must not be 0
+      uint32_t decimation;
+  };
+
+  /**
+   * Sine set point with a period of a whole number of ticks, as used by the sine tracking tests.
+   *
+   * As in those tests the time wraps each period and the previous target is the sine one step before the
+   * wrapped time, so at the start of a period it is taken at -step rather than at the end of the last period.
+   */
+  template<typename SINE, typename TIME>
+  class SineSetpoint {
+    private:
+      SINE &_sine;
+      TIME _step;
+      uint64_t _ticksPerPeriod;
+
+    public:
+      SineSetpoint(SINE &sine, TIME step, uint64_t ticksPerPeriod) :
+              _sine(sine),
+              _step(step),
+              _ticksPerPeriod(ticksPerPeriod) {
+      }
+
+      double operator()(uint64_t tick) const {
+        return _sine.calculateSine(static_cast<int32_t>(tick % _ticksPerPeriod) * _step).asDouble();
+      }
+
+      double previous(uint64_t tick) const {
+        return _sine.calculateSine(static_cast<int32_t>(tick % _ticksPerPeriod) * _step - _step).asDouble();
+      }
+  };
+
+  template<typename SETPOINT>
+  auto previousTarget(const SETPOINT &setpoint, uint64_t tick, int) -> decltype(setpoint.previous(tick)) {
+    return setpoint.previous(tick);
+  }
+
+  template<typename SETPOINT>
+  double previousTarget(const SETPOINT &setpoint, uint64_t tick, long) {
+    return setpoint(tick - 1);
+  }
+
+  /**
+   * The target the controller corrects against on a tick: setpoint.previous(tick) where the set point
+   * defines it, otherwise the set point of the tick before.
+   */
+  template<typename SETPOINT>
+  double previousTarget(const SETPOINT &setpoint, uint64_t tick) {
+    return previousTarget(setpoint, tick, 0);
+  }
+
+  struct StepSetpoint {
+      double before;
+      double after;
+      uint64_t atTick;
+
+      double operator()(uint64_t tick) const {
+        return (tick < atTick) ? before : after;
+      }
+  };
+
+  /**
+   * Speed rising linearly from start to end over the given ticks then holding.
+   */
+  struct SpeedRamp {
+      double start;
+      double end;
+      uint64_t ticks;
+
+      double operator()(uint64_t tick) const {
+        return (tick >= ticks) ? end : start + (end - start) * static_cast<double>(tick) / static_cast<double>(ticks);
+      }
+  };
+
+  struct ConstantSpeed {
+      double speed;
+
+      double operator()(uint64_t) const {
+        return speed;
+      }
+  };
+
+  struct NullTrace {
+      void record(const SimulationSample &) {
+      }
+  };
+
+  /**
+   * Streams the samples as CSV with a header line.
+   */
+  class CsvTrace {
+    private:
+      std::ostream &_out;
+
+    public:
+      explicit CsvTrace(std::ostream &out) :
+              _out(out) {
+        _out << "tick,target,current,correction,speed,duty\n";
+      }
+
+      void record(const SimulationSample &sample) {
+        _out << sample.tick << ',' << sample.target << ',' << sample.current << ',' << sample.correction << ','
+             << sample.speed << ',' << sample.duty << '\n';
+      }
+  };
+
+  /**
+   * Streams the samples as fixed size binary records, buffered so a long run costs one write per RECORDS
+   * samples. Each record is the fields of SimulationSample in declaration order in host byte order with no
+   * padding, RECORD_SIZE bytes; decode() reads one back.
+   */
+  class BinaryTrace {
+    private:
+      static constexpr size_t RECORDS = 4096;
+
+      std::ostream &_out;
+      std::vector<char> _buffer;
+
+      template<typename V>
+      void put(const V &value) {
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        _buffer.insert(_buffer.end(), bytes, bytes + sizeof(V));
+      }
+
+      template<typename V>
+      static const char *get(const char *data, V &value) {
+        std::memcpy(&value, data, sizeof(V));
+        return data + sizeof(V);
+      }
+
+    public:
+      static constexpr size_t RECORD_SIZE = sizeof(uint64_t) + 4 * sizeof(double) + sizeof(int32_t);
+
+      explicit BinaryTrace(std::ostream &out) :
+              _out(out) {
+        _buffer.reserve(RECORDS * RECORD_SIZE);
+      }
+
+      ~BinaryTrace() {
+        flush();
+      }
+
+      BinaryTrace(const BinaryTrace &) = delete;
+      BinaryTrace &operator=(const BinaryTrace &) = delete;
+
+      void record(const SimulationSample &sample) {
+        put(sample.tick);
+        put(sample.target);
+        put(sample.current);
+        put(sample.correction);
+        put(sample.speed);
+        put(sample.duty);
+        if( _buffer.size() == RECORDS * RECORD_SIZE ) {
+          flush();
+        }
+      }
+
+      void flush() {
+        _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+      }
+
+      /**
+       * The sample in the RECORD_SIZE bytes at data.
+       */
+      static SimulationSample decode(const char *data) {
+        SimulationSample sample;
+        data = get(data, sample.tick);
+        data = get(data, sample.target);
+        data = get(data, sample.current);
+        data = get(data, sample.correction);
+        data = get(data, sample.speed);
+        get(data, sample.duty);
+        return sample;
+      }
+  };
+
+  /**
+   * The closed loop used by the stepper tests: every tick the controller corrects the target from the
+   * measured current, the model turns that into a duty cycle and the plant runs for a number of PWM cycles.
+   *
+   * The controller, model and plant are held by reference and used through the same calls as in the hand
+   * written loops, so any of PidController, RuntimePidController, StepperPredictiveModel, DutyCycleTable
+   * and StepperPlantModel can be plugged in. T is the controller and model number type; the plant runs in
+   * double. The set point and speed are callables taking the tick number.
+   *
+   * STATE is the type the current is held in between plant cycles. The fixed point tests keep it in their
+   * FixedPoint type, so the current is rounded after every cycle as it was in their loops.
+   *
+   * The error tracked is previousTarget() against the current at the start of the tick, matching the
+   * existing tests. The squared errors are summed in STATE, so a fixed point simulation loses squares below
+   * its resolution as the fixed point loops did.
+   */
+  template<typename T, typename CONTROLLER, typename MODEL, typename PLANT, typename STATE = double>
+  class ClosedLoopSimulation {
+    private:
+      CONTROLLER &_controller;
+      MODEL &_model;
+      PLANT &_plant;
+      SimulationConfig _config;
+      PwmChannel _negativeChannel;
+
+      uint64_t _tick;
+      double _current;
+      STATE _errorSquared;
+      double _maxError;
+      uint64_t _samples;
+
+      static double toDouble(double value) {
+        return value;
+      }
+
+      template<typename V>
+      static double toDouble(const V &value) {
+        return value.asDouble();
+      }
+
+      static double held(double current) {
+        return toDouble(STATE(current));
+      }
+
+      /**
+       * A decimation of 0 would divide by zero on every tick. It calls logError and, should that return,
+       * records every tick.
+       */
+      static SimulationConfig checkedConfig(SimulationConfig config) {
+        if( config.decimation == 0 ) {
+          logError(static_cast<Assert::FatalRecoveryOption>(0), static_cast<Assert::FatalErrorCode>(0),
+              config.decimation);
+          config.decimation = 1;
+        }
+        return config;
+      }
+
+    public:
+      ClosedLoopSimulation(CONTROLLER &controller, MODEL &model, PLANT &plant, PwmChannel negative,
+          SimulationConfig config = {10, 1}, double initialCurrent = 0.0) :
+              _controller(controller),
+              _model(model),
+              _plant(plant),
+              _config(checkedConfig(config)),
+              _negativeChannel(negative),
+              _tick(0),
+              _current(held(initialCurrent)),
+              _errorSquared(STATE(0.0)),
+              _maxError(0.0),
+              _samples(0) {
+      }
+
+      /**
+       * Run for the given number of ticks, continuing from the last tick run.
+       */
+      template<typename SETPOINT, typename SPEED, typename TRACE>
+      void run(uint64_t ticks, const SETPOINT &setpoint, const SPEED &speed, TRACE &trace) {
+        for( uint64_t n = 0; n < ticks; n++ ) {
+          const uint64_t tick = ++_tick;
+          const double target = setpoint(tick);
+          const double previousTarget = Drivers::previousTarget(setpoint, tick);
+          const double tickSpeed = speed(tick);
+
+          const double delta = std::fabs(previousTarget - _current);
+          const STATE error = STATE(previousTarget) - STATE(_current);
+          _errorSquared = _errorSquared + error * error;
+          _maxError = (delta > _maxError) ? delta : _maxError;
+          _samples++;
+
+          const T current = T(_current);
+          const T correction = _controller.computeOutput(current, T(previousTarget));
+          const DutyCycle duty = _model.computeDutyCycle(T(tickSpeed), correction + T(target), current);
+          for( uint32_t cycle = 0; cycle < _config.plantCyclesPerTick; cycle++ ) {
+            _current = held(_plant.computeCurrentAtEndOfCycle(tickSpeed, _current, duty));
+          }
+
+          if( tick % _config.decimation == 0 ) {
+            int32_t signedDuty = (duty.channel == _negativeChannel) ? -static_cast<int32_t>(duty.duty) : duty.duty;
+            trace.record({tick, target, _current, toDouble(correction), tickSpeed, signedDuty});
+          }
+        }
+      }
+
+      template<typename SETPOINT, typename SPEED>
+      void run(uint64_t ticks, const SETPOINT &setpoint, const SPEED &speed) {
+        NullTrace trace;
+        run(ticks, setpoint, speed, trace);
+      }
+
+      /**
+       * Restart the error statistics, e.g. once the loop has settled.
+       */
+      void resetErrors() {
+        _errorSquared = STATE(0.0);
+        _maxError = 0.0;
+        _samples = 0;
+      }
+
+      uint64_t tick() const {
+        return _tick;
+      }
+
+      double current() const {
+        return _current;
+      }
+
+      double rmsError() const {
+        return _samples ? std::sqrt(toDouble(_errorSquared) / static_cast<double>(_samples)) : 0.0;
+      }
+
+      double maxError() const {
+        return _maxError;
+      }
+  };
+
+  /**
+   * Deduces the simulation type from its parts, e.g. makeSimulation<FP>(...) or, holding the current in
+   * the fixed point type, makeSimulation<FP, FP>(...).
+   */
+  template<typename T, typename STATE = double, typename CONTROLLER, typename MODEL, typename PLANT>
+  ClosedLoopSimulation<T, CONTROLLER, MODEL, PLANT, STATE> makeSimulation(CONTROLLER &controller, MODEL &model,
+      PLANT &plant, PwmChannel negative, SimulationConfig config = {10, 1}, double initialCurrent = 0.0) {
+    return ClosedLoopSimulation<T, CONTROLLER, MODEL, PLANT, STATE>(controller, model, plant, negative, config,
+        initialCurrent);
+  }
+
+}
+
+#endif
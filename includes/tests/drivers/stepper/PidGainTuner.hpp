@@ -0,0 +1,260 @@
+#ifndef INCLUDES_TESTS_DRIVERS_STEPPER_PIDGAINTUNER_HPP_
+#define INCLUDES_TESTS_DRIVERS_STEPPER_PIDGAINTUNER_HPP_
+
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Drivers {
+
+  /**
+   * The PID tuning parameters searched by the tuner. Limits are carried along so the emitted parameters
+   * are complete.
+   */
+  struct PidGains {
+      double Kp;
+      double Ki;
+      double Kd;
+      double maxOutput;
+      double minOutput;
+      double maxIntegral;
+  };
+
+  /**
+   * The candidate gains in the form used by RuntimePidController, resetting to zero as the emitted
+   * TestParameters do.
+   */
+  template<typename T>
+  PidTuning<T> toTuning(const PidGains &gains) {
+    return {T(gains.Kp), T(gains.Ki), T(gains.Kd), T(gains.maxOutput), T(gains.minOutput), T(gains.maxIntegral),
+      T(0.0), T(0.0)};
+  }
+
+  /**
+   * Searches the (Kp, Ki, Kd) space for the gains with the lowest cost.
+   *
+   * A coarse grid over the given ranges is evaluated first with the candidates spread over a pool of
+   * threads, then Nelder-Mead refines from the best grid point. The cost function must be thread safe;
+   * in practice each call builds its own controller, model and plant.
+   *
+   * A batch cost function takes a block of candidates and returns their costs, so one
+   * BatchStepperPlantModel can run every candidate of the block together. The grid is then split into one
+   * block per thread.
+   */
+  class PidGainTuner {
+    public:
+      using CostFunction = std::function<double(const PidGains &)>;
+      using BatchCostFunction = std::function<std::vector<double>(const std::vector<PidGains> &)>;
+
+      struct Range {
+          double min;
+          double max;
+      };
+
+      struct Result {
+          PidGains gains;
+          double cost;
+          uint32_t evaluations;
+      };
+
+    private:
+      CostFunction _cost;
+      BatchCostFunction _batchCost;
+      PidGains _limits;
+      uint32_t _threads;
+      uint32_t _evaluations;
+
+      PidGains withGains(const double (&k)[3]) const {
+        PidGains gains = _limits;
+        gains.Kp = k[0];
+        gains.Ki = k[1];
+        gains.Kd = k[2];
+        return gains;
+      }
+
+      double evaluate(const double (&k)[3]) {
+        _evaluations++;
+        return _cost ? _cost(withGains(k)) : _batchCost({withGains(k)})[0];
+      }
+
+      /**
+       * Evaluate every candidate, spreading them over the thread pool.
+       */
+      std::vector<double> evaluateAll(const std::vector<PidGains> &candidates) {
+        std::vector<double> costs(candidates.size());
+        std::atomic<size_t> next(0);
+        const size_t block = (candidates.size() + _threads - 1) / _threads;
+        auto worker = [&]() {
+          if( _cost ) {
+            for( size_t i = next++; i < candidates.size(); i = next++ ) {
+              costs[i] = _cost(candidates[i]);
+            }
+            return;
+          }
+          for( size_t first = next.fetch_add(block); first < candidates.size(); first = next.fetch_add(block) ) {
+            const size_t last = std::min(first + block, candidates.size());
+            auto blockCosts = _batchCost(std::vector<PidGains>(candidates.begin() + first, candidates.begin() + last));
+            std::copy(blockCosts.begin(), blockCosts.end(), costs.begin() + first);
+          }
+        };
+        std::vector<std::thread> pool;
+        for( uint32_t t = 1; t < _threads; t++ ) {
+          pool.emplace_back(worker);
+        }
+        worker();
+        for( auto &thread : pool ) {
+          thread.join();
+        }
+        _evaluations += static_cast<uint32_t>(candidates.size());
+        return costs;
+      }
+
+      void nelderMead(double (&best)[3], double &bestCost, const double (&scale)[3], uint32_t iterations) {
+        double simplex[4][3];
+        double cost[4];
+        for( uint32_t v = 0; v < 4; v++ ) {
+          for( uint32_t d = 0; d < 3; d++ ) {
+            simplex[v][d] = best[d] + ((v == d + 1) ? scale[d] : 0.0);
+          }
+          cost[v] = (v == 0) ? bestCost : evaluate(simplex[v]);
+        }
+        for( uint32_t it = 0; it < iterations; it++ ) {
+          uint32_t order[4] = {0, 1, 2, 3};
+          std::sort(order, order + 4, [&](uint32_t a, uint32_t b) {return cost[a] < cost[b];});
+          const uint32_t worst = order[3];
+          double centroid[3] = {0.0, 0.0, 0.0};
+          for( uint32_t v = 0; v < 3; v++ ) {
+            for( uint32_t d = 0; d < 3; d++ ) {
+              centroid[d] += simplex[order[v]][d] / 3.0;
+            }
+          }
+          auto along = [&](double t, double (&point)[3]) {
+            for( uint32_t d = 0; d < 3; d++ ) {
+              point[d] = centroid[d] + t * (simplex[worst][d] - centroid[d]);
+            }
+          };
+          double reflected[3];
+          along(-1.0, reflected);
+          double reflectedCost = evaluate(reflected);
+          if( reflectedCost < cost[order[0]] ) {
+            double expanded[3];
+            along(-2.0, expanded);
+            double expandedCost = evaluate(expanded);
+            bool useExpanded = expandedCost < reflectedCost;
+            std::copy(useExpanded ? expanded : reflected, (useExpanded ? expanded : reflected) + 3, simplex[worst]);
+            cost[worst] = useExpanded ? expandedCost : reflectedCost;
+          } else if( reflectedCost < cost[order[2]] ) {
+            std::copy(reflected, reflected + 3, simplex[worst]);
+            cost[worst] = reflectedCost;
+          } else {
+            double contracted[3];
+            along(0.5, contracted);
+            double contractedCost = evaluate(contracted);
+            if( contractedCost < cost[worst] ) {
+              std::copy(contracted, contracted + 3, simplex[worst]);
+              cost[worst] = contractedCost;
+            } else {
+              // shrink towards the best point
+              for( uint32_t v = 1; v < 4; v++ ) {
+                for( uint32_t d = 0; d < 3; d++ ) {
+                  simplex[order[v]][d] = simplex[order[0]][d] + 0.5 * (simplex[order[v]][d] - simplex[order[0]][d]);
+                }
+                cost[order[v]] = evaluate(simplex[order[v]]);
+              }
+            }
+          }
+        }
+        for( uint32_t v = 0; v < 4; v++ ) {
+          if( cost[v] < bestCost ) {
+            bestCost = cost[v];
+            std::copy(simplex[v], simplex[v] + 3, best);
+          }
+        }
+      }
+
+    public:
+      /**
+       * @param cost the cost of a set of gains, lower is better
+       * @param limits the output and integral limits to use for every candidate
+       * @param threads number of threads to evaluate the grid with, 0 uses the hardware concurrency
+       */
+      PidGainTuner(CostFunction cost, const PidGains &limits, uint32_t threads = 0) :
+              _cost(std::move(cost)),
+              _limits(limits),
+              _threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+              _evaluations(0) {
+      }
+
+      /**
+       * @param batchCost the costs of a block of gains, in the same order, lower is better
+       */
+      PidGainTuner(BatchCostFunction batchCost, const PidGains &limits, uint32_t threads = 0) :
+              _batchCost(std::move(batchCost)),
+              _limits(limits),
+              _threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+              _evaluations(0) {
+      }
+
+      Result tune(Range kp, Range ki, Range kd, uint32_t gridSteps, uint32_t iterations) {
+        _evaluations = 0;
+        const Range ranges[3] = {kp, ki, kd};
+        double step[3];
+        for( uint32_t d = 0; d < 3; d++ ) {
+          step[d] = (gridSteps > 1) ? (ranges[d].max - ranges[d].min) / (gridSteps - 1) : 0.0;
+        }
+
+        std::vector<PidGains> candidates;
+        for( uint32_t p = 0; p < gridSteps; p++ ) {
+          for( uint32_t i = 0; i < gridSteps; i++ ) {
+            for( uint32_t d = 0; d < gridSteps; d++ ) {
+              const double k[3] = {kp.min + p * step[0], ki.min + i * step[1], kd.min + d * step[2]};
+              candidates.push_back(withGains(k));
+            }
+          }
+        }
+        auto costs = evaluateAll(candidates);
+        size_t bestIndex = static_cast<size_t>(std::min_element(costs.begin(), costs.end()) - costs.begin());
+
+        double best[3] = {candidates[bestIndex].Kp, candidates[bestIndex].Ki, candidates[bestIndex].Kd};
+        double bestCost = costs[bestIndex];
+        const double scale[3] = {step[0] / 2, step[1] / 2, step[2] / 2};
+        nelderMead(best, bestCost, scale, iterations);
+        return {withGains(best), bestCost, _evaluations};
+      }
+  };
+
+  /**
+   * Write the gains as a TestParameters struct in the form used by the PID tests.
+   *
+   * @param numType the C++ type of the parameters e.g. "double" or "numeric::FixedPoint<16, int32_t>"
+   */
+  inline void writeTestParameters(std::ostream &out, const PidGains &gains, const std::string &numType) {
+    bool isDouble = (numType == "double");
+    auto value = [&](double v) {
+      return isDouble ? std::to_string(v) : "NumType(" + std::to_string(v) + ")";
+    };
+    std::string type = isDouble ? "double" : "NumType";
+    out << "struct TestParameters {\n";
+    out << "    using NumType = " << numType << ";\n";
+    out << "    static constexpr " << type << " Kd = " << value(gains.Kd) << ";\n";
+    out << "    static constexpr " << type << " Kp = " << value(gains.Kp) << ";\n";
+    out << "    static constexpr " << type << " Ki = " << value(gains.Ki) << ";\n";
+    out << "    static constexpr " << type << " MAX_OUTPUT_VALUE = " << value(gains.maxOutput) << ";\n";
+    out << "    static constexpr " << type << " MIN_OUTPUT_VALUE = " << value(gains.minOutput) << ";\n";
+    out << "    static constexpr " << type << " MAX_INTEGRAL = " << value(gains.maxIntegral) << ";\n";
+    out << "    static constexpr " << type << " RESET_VALUE_ERROR = " << value(0.0) << ";\n";
+    out << "    static constexpr " << type << " RESET_VALUE_INTEGRAL = " << value(0.0) << ";\n";
+    out << "    static constexpr " << type << " RESET_VALUE_SETPOINT = " << value(0.0) << ";\n";
+    out << "};\n";
+  }
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef INCLUDES_TESTS_DRIVERS_STEPPER_STEPPERMOTORMODEL_HPP_
+#define INCLUDES_TESTS_DRIVERS_STEPPER_STEPPERMOTORMODEL_HPP_
+
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <drivers/timers/PwmTypes.hpp>
+#include <cmath>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * Electrical and mechanical parameters of a two phase hybrid stepper. Angles and speeds are electrical
+   * (one electrical revolution is four full steps), torques and inertia are at the shaft.
+   */
+  struct MotorParameters {
+      double V;
+      double R;
+      double L;
+      // back emf in volts per electrical rad/s
+      double k;
+      // electrical revolutions per mechanical revolution, 50 for a 1.8 degree motor
+      double polePairs;
+      // kg m^2
+      double inertia;
+      // N m per mechanical rad/s
+      double damping;
+      // N m opposing positive rotation
+      double loadTorque;
+      // PWM period in seconds
+      double period;
+      int32_t ticks;
+  };
+
+  /**
+   * Two coil stepper motor with a rotor. Each coil is a StepperPlantModel driven with its own duty cycle and
+   * the back emf the rotor induces in it; the coil currents then produce the torque that moves the rotor.
+   *
+   * Coil A has its axis at electrical angle 0 and coil B at pi/2, so with the rotor at angle theta turning
+   * at w the back emfs are -k*w*sin(theta) and k*w*cos(theta) and the torque is
+   *   polePairs * k * (iB*cos(theta) - iA*sin(theta)).
+   * StepperPlantModel takes the emf as k*speed in the frame of the channel being driven so the projected
+   * speed is negated when a coil is driven from the negative channel.
+   */
+  class StepperMotorModel {
+    private:
+      MotorParameters _parameters;
+      StepperPlantModel<double> _coilA;
+      StepperPlantModel<double> _coilB;
+      PwmChannel _negativeChannel;
+
+      double _angle;
+      double _speed;
+      double _currentA;
+      double _currentB;
+
+      double coilSpeed(double projection, DutyCycle duty) const {
+        return (duty.channel == _negativeChannel) ? -projection : projection;
+      }
+
+    public:
+      StepperMotorModel(const MotorParameters &parameters, PwmChannel positive, PwmChannel negative) :
+              _parameters(parameters),
+              _coilA(parameters.V, parameters.R, parameters.L, parameters.k, parameters.period, positive, negative,
+                  parameters.ticks, PlantEvaluation::CACHED),
+              _coilB(parameters.V, parameters.R, parameters.L, parameters.k, parameters.period, positive, negative,
+                  parameters.ticks, PlantEvaluation::CACHED),
+              _negativeChannel(negative),
+              _angle(0.0),
+              _speed(0.0),
+              _currentA(0.0),
+              _currentB(0.0) {
+      }
+
+      /**
+       * Electrical rotor angle in radians, unwrapped.
+       */
+      double angle() const {
+        return _angle;
+      }
+
+      /**
+       * Electrical speed in rad/s.
+       */
+      double speed() const {
+        return _speed;
+      }
+
+      double currentA() const {
+        return _currentA;
+      }
+
+      double currentB() const {
+        return _currentB;
+      }
+
+      /**
+       * The speed to give a coil's predictive model so its back emf matches the motor.
+       */
+      double speedSeenByA() const {
+        return -_speed * std::sin(_angle);
+      }
+
+      double speedSeenByB() const {
+        return _speed * std::cos(_angle);
+      }
+
+      double torque() const {
+        return _parameters.polePairs * _parameters.k * (_currentB * std::cos(_angle) - _currentA * std::sin(_angle));
+      }
+
+      /**
+       * Run one PWM cycle on both coils then advance the rotor over the same period.
+       */
+      void runCycle(DutyCycle dutyA, DutyCycle dutyB) {
+        const double projectionA = speedSeenByA();
+        const double projectionB = speedSeenByB();
+        _currentA = _coilA.computeCurrentAtEndOfCycle(coilSpeed(projectionA, dutyA), _currentA, dutyA);
+        _currentB = _coilB.computeCurrentAtEndOfCycle(coilSpeed(projectionB, dutyB), _currentB, dutyB);
+
+        const double mechanicalSpeed = _speed / _parameters.polePairs;
+        const double net = torque() - _parameters.damping * mechanicalSpeed - _parameters.loadTorque;
+        _speed += _parameters.polePairs * net / _parameters.inertia * _parameters.period;
+        _angle += _speed * _parameters.period;
+      }
+  };
+
+}
+
+#endif
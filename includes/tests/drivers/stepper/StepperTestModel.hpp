@@ -5,6 +5,7 @@
 #include <drivers/timers/PwmTypes.hpp>
 #include <cmath>
 #include <type_traits>
+#include <vector>
 
 namespace Drivers {
   template<typename T>
@@ -27,6 +28,19 @@ namespace Drivers {
     return T(std::exp(val));
   }
 
+  /**
+   * How the plant evaluates a PWM cycle.
+   *
+   * ANALYTIC solves for the equivalent start times with log/exp on every cycle.
+   * CACHED precomputes exp(-R/L*ton) and exp(-R/L*toff) for every duty value and uses the recurrence
+   *   i(t) = Iinf + (i0 - Iinf) * exp(-R/L*t)
+   * so a cycle is a handful of multiplies.
+   */
+  enum class PlantEvaluation {
+    ANALYTIC,
+    CACHED
+  };
+
   /**
    * Models the relationship between the requested rate of rise and on time of the duty cycle
    */
@@ -44,6 +58,10 @@ namespace Drivers {
       PwmChannel _positiveChannel;
       PwmChannel _negativeChannel;
 
+      // decay factors indexed by duty, only filled for PlantEvaluation::CACHED
+      std::vector<Number> _onDecay;
+      std::vector<Number> _offDecay;
+
       static constexpr Number one = Number(1.0);
 
     public:
@@ -72,11 +90,13 @@ namespace Drivers {
        * @param ticks the number of PWM counts in a period
        * @param positive the PWM channel that causes positive current in the coil
        * @param negative the PWM channel that causes negative current in the coil
+       * @param evaluation whether to solve each cycle analytically or from cached decay factors
        *
        * The
        */
       StepperPlantModel(Number V, Number coilResistance, Number coilInductance, Number k, Number period,
-          PwmChannel positive, PwmChannel negative, int32_t ticks) :
+          PwmChannel positive, PwmChannel negative, int32_t ticks,
+          PlantEvaluation evaluation = PlantEvaluation::ANALYTIC) :
               _coilR(coilResistance),
               _coilL(coilInductance),
               _v(V),
@@ -85,6 +105,16 @@ namespace Drivers {
               _ticks(ticks),
               _positiveChannel(positive),
               _negativeChannel(negative) {
+        if (evaluation == PlantEvaluation::CACHED) {
+          _onDecay.reserve(_ticks + 1);
+          _offDecay.reserve(_ticks + 1);
+          for (int32_t duty = 0; duty <= _ticks; duty++) {
+            auto ton = _period * duty / _ticks;
+            auto toff = _period * (_ticks - duty) / _ticks;
+            _onDecay.push_back(exp(-_coilR / _coilL * ton));
+            _offDecay.push_back(exp(-_coilR / _coilL * toff));
+          }
+        }
       }
 
       Number delayFromStartCurrent(const Number &startI, Number speed) {
@@ -104,6 +134,9 @@ namespace Drivers {
        __attribute__((noinline))
        inline Number computeCurrentAtEndOfCycle(Number speed,
           Number initialCurrent, DutyCycle duty) {
+        if (!_onDecay.empty()) {
+          return computeCachedCurrentAtEndOfCycle(speed, initialCurrent, duty);
+        }
         if (duty.channel == _negativeChannel) {
           initialCurrent = -initialCurrent;
         }
@@ -119,6 +152,23 @@ namespace Drivers {
         return Ifinal;
       }
 
+      /**
+       * Same as computeCurrentAtEndOfCycle but using the cached decay factors. The on phase decays towards
+       * Iinf = (V-k*s)/R and the off phase towards -Iinf. A duty above ticks throws std::out_of_range.
+       */
+      inline Number computeCachedCurrentAtEndOfCycle(Number speed, Number initialCurrent, DutyCycle duty) {
+        if (duty.channel == _negativeChannel) {
+          initialCurrent = -initialCurrent;
+        }
+        auto Iinf = (_v - _emfK * speed) / _coilR;
+        auto Ipeak = Iinf + (initialCurrent - Iinf) * _onDecay.at(duty.duty);
+        auto Ifinal = -Iinf + (Ipeak + Iinf) * _offDecay.at(duty.duty);
+        if (duty.channel == _negativeChannel) {
+          Ifinal = -Ifinal;
+        }
+        return Ifinal;
+      }
+
       /**
        * Compute the final current at the end of a complete cycle for a given duty ratio,
        * initial current and speed
@@ -0,0 +1,162 @@
+#ifndef INCLUDES_WAVEFORMS_INTERPOLATEDSINELOOKUP_HPP_
+#define INCLUDES_WAVEFORMS_INTERPOLATEDSINELOOKUP_HPP_
+
+#include <drivers/timers/CycleBudget.hpp>
+#include <numeric/FixedPoint.hpp>
+#include <numeric/FixedPointTraits.hpp>
+#include <array>
+#include <cstdint>
+
+namespace waveforms {
+
+  enum class Interpolation {
+    LINEAR,
+    QUADRATIC
+  };
+
+  /**
+   * Sine lookup with a quarter wave table of QUARTER_SIZE steps generated at compile time.
+   *
+   * The phase is a 32 bit value where 2^32 is one full period. The top two bits select the quadrant and the
+   * remaining bits are split into a table index and an interpolation fraction. The table is stored in Q30
+   * so the precision is limited by the table size and interpolation rather than the stored values.
+   *
+   * Worst case error against sin() with a FixedPoint<22> result:
+   *
+   *   QUARTER_SIZE   LINEAR    QUADRATIC   flash
+   *        16        1.2e-3    6.1e-5        76 bytes
+   *        64        7.6e-5    1.2e-6       268 bytes
+   *       256        4.9e-6    2.5e-7      1036 bytes
+   *
+   * The 256 step SineLookup is accurate at its own steps but the generators need a 0.0025 tolerance in between.
+   */
+  template<uint32_t QUARTER_SIZE, Interpolation MODE = Interpolation::LINEAR>
+  class InterpolatedSineLookup {
+    private:
+      static_assert((QUARTER_SIZE & (QUARTER_SIZE - 1)) == 0, "QUARTER_SIZE must be a power of 2");
+      static_assert(QUARTER_SIZE >= 4 && QUARTER_SIZE <= (1u << 20), "QUARTER_SIZE out of range");
+
+      static constexpr int32_t TABLE_FRACTION = 30;
+      static constexpr uint32_t QUADRANT_SHIFT = 30;
+      static constexpr uint32_t QUADRANT_MASK = (1u << QUADRANT_SHIFT) - 1;
+
+      static constexpr uint32_t log2(uint32_t n) {
+        uint32_t bits = 0;
+        while( n > 1 ) {
+          n >>= 1;
+          bits++;
+        }
+        return bits;
+      }
+
+      static constexpr uint32_t FRACTION_BITS = QUADRANT_SHIFT - log2(QUARTER_SIZE);
+      static constexpr uint32_t FRACTION_MASK = (1u << FRACTION_BITS) - 1;
+
+      /**
+       * Taylor series for sine, only used to build the table so it never needs to be fast.
+       */
+      static constexpr double taylorSine(double x) {
+        double term = x;
+        double sum = x;
+        for( int32_t n = 1; n < 16; n++ ) {
+          term = -term * x * x / ((2 * n) * (2 * n + 1));
+          sum = sum + term;
+        }
+        return sum;
+      }
+
+      /**
+       * Entries past QUARTER_SIZE let the interpolation read ahead without checking for the end of the table.
+       */
+      static constexpr std::array<int32_t, QUARTER_SIZE + 3> generate() {
+        constexpr double HALF_PI = 1.5707963267948966;
+        std::array<int32_t, QUARTER_SIZE + 3> table{};
+        for( uint32_t i = 0; i < QUARTER_SIZE + 3; i++ ) {
+          double value = taylorSine(HALF_PI * i / QUARTER_SIZE) * (1 << TABLE_FRACTION);
+          table[i] = static_cast<int32_t>(value >= 0 ? value + 0.5 : value - 0.5);
+        }
+        return table;
+      }
+
+      static constexpr std::array<int32_t, QUARTER_SIZE + 3> TABLE = generate();
+
+      /**
+       * Sine in Q30 for a position in the first quadrant, 0 <= position <= 2^30.
+       */
+      static int32_t quarterSine(uint32_t position) {
+        const uint32_t index = position >> FRACTION_BITS;
+        const int64_t t = position & FRACTION_MASK;
+        const int64_t y0 = TABLE[index];
+        const int64_t y1 = TABLE[index + 1];
+        if constexpr (MODE == Interpolation::LINEAR) {
+          return static_cast<int32_t>(y0 + (((y1 - y0) * t) >> FRACTION_BITS));
+        } else {
+          // Newton forward difference: y0 + t*d1 + t(t-1)/2*d2
+          const int64_t y2 = TABLE[index + 2];
+          const int64_t d1 = y1 - y0;
+          const int64_t d2 = y2 - 2 * y1 + y0;
+          const int64_t tt = (t * (t - (int64_t(1) << FRACTION_BITS))) >> (FRACTION_BITS + 1);
+          return static_cast<int32_t>(y0 + ((d1 * t) >> FRACTION_BITS) + ((d2 * tt) >> FRACTION_BITS));
+        }
+      }
+
+    public:
+      static constexpr uint32_t TABLE_BYTES = sizeof(TABLE);
+
+      /**
+       * Sine of the phase where 2^32 is one full period.
+       */
+      template<typename FP>
+      static FP calculateSine(uint32_t phase) {
+        CYCLE_BUDGET_SCOPE("InterpolatedSineLookup::calculateSine");
+        const uint32_t quadrant = phase >> QUADRANT_SHIFT;
+        uint32_t position = phase & QUADRANT_MASK;
+        if( quadrant & 1 ) {
+          position = (1u << QUADRANT_SHIFT) - position;
+        }
+        int32_t value = quarterSine(position);
+        if( quadrant & 2 ) {
+          value = -value;
+        }
+        return numeric::fromRaw<FP, TABLE_FRACTION>(value);
+      }
+
+      /**
+       * Sine and cosine of the same phase from a single decode of the phase.
+       *
+       * Within a quadrant one of the pair is read at the position and the other at the mirrored position so
+       * both come from the same quarter table and only the signs depend on the quadrant. The mirrored
+       * position falls between different table entries, so this is still two interpolations (four table
+       * reads, six for QUADRATIC); only the quadrant decode is shared. The result matches calculateSine and
+       * calculateCosine bit for bit.
+       */
+      template<typename FP>
+      static void calculateSineCosine(uint32_t phase, FP &sine, FP &cosine) {
+        const uint32_t quadrant = phase >> QUADRANT_SHIFT;
+        const uint32_t position = phase & QUADRANT_MASK;
+        const int32_t direct = quarterSine(position);
+        const int32_t mirrored = quarterSine((1u << QUADRANT_SHIFT) - position);
+        int32_t s = (quadrant & 1) ? mirrored : direct;
+        int32_t c = (quadrant & 1) ? direct : mirrored;
+        if( quadrant & 2 ) {
+          s = -s;
+        }
+        if( (quadrant + 1) & 2 ) {
+          c = -c;
+        }
+        sine = numeric::fromRaw<FP, TABLE_FRACTION>(s);
+        cosine = numeric::fromRaw<FP, TABLE_FRACTION>(c);
+      }
+
+      /**
+       * Cosine of the phase where 2^32 is one full period.
+       */
+      template<typename FP>
+      static FP calculateCosine(uint32_t phase) {
+        return calculateSine<FP>(phase + (1u << QUADRANT_SHIFT));
+      }
+  };
+
+}
+
+#endif
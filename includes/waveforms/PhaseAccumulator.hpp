@@ -0,0 +1,81 @@
+#ifndef INCLUDES_WAVEFORMS_PHASEACCUMULATOR_HPP_
+#define INCLUDES_WAVEFORMS_PHASEACCUMULATOR_HPP_
+
+#include <SolexOs/Assert.hpp>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * 32 bit phase accumulator where 2^32 is one full period.
+   *
+   * The increment is computed once at construction. If the period is not an exact multiple of the
+   * sample interval the remainder is carried in an error term (as in Bresenham's line algorithm) so the
+   * phase does not drift over long runs. Wrapping at the end of the period is free as the accumulator
+   * simply overflows.
+   */
+  class PhaseAccumulator {
+    private:
+      uint32_t _modulus;
+      uint32_t _phase;
+      uint32_t _increment;
+      uint32_t _error;
+      uint32_t _remainder;
+
+      /**
+       * A period of zero samples has no phase increment. It calls logError and, should that return, runs at
+       * one step per period rather than dividing by zero.
+       */
+      static uint32_t checkedPeriod(uint32_t period) {
+        if( period == 0 ) {
+          logError(static_cast<Assert::FatalRecoveryOption>(0), static_cast<Assert::FatalErrorCode>(0), period);
+          return 1;
+        }
+        return period;
+      }
+
+    public:
+      /**
+       * Advance by period/samplesPerPeriod on each step.
+       */
+      explicit PhaseAccumulator(uint32_t samplesPerPeriod) :
+              PhaseAccumulator(1, samplesPerPeriod) {
+      }
+
+      /**
+       * Advance by step/period of a period on each step. Both are in the same (raw) units and the period
+       * must not be zero; zero is reported through logError.
+       */
+      PhaseAccumulator(uint32_t step, uint32_t period) :
+              _modulus(checkedPeriod(period)),
+              _phase(0),
+              _increment(static_cast<uint32_t>((uint64_t(step) << 32) / _modulus)),
+              _error(0),
+              _remainder(static_cast<uint32_t>((uint64_t(step) << 32) % _modulus)) {
+      }
+
+      /**
+       * Restart at the given phase.
+       */
+      void reset(uint32_t phase = 0) {
+        _phase = phase;
+        _error = 0;
+      }
+
+      uint32_t phase() const {
+        return _phase;
+      }
+
+      void advance() {
+        _phase += _increment;
+        _error += _remainder;
+        if( _error >= _modulus ) {
+          _error -= _modulus;
+          _phase++;
+        }
+      }
+  };
+
+}
+
+#endif
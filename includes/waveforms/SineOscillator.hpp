@@ -0,0 +1,98 @@
+#ifndef INCLUDES_WAVEFORMS_SINEOSCILLATOR_HPP_
+#define INCLUDES_WAVEFORMS_SINEOSCILLATOR_HPP_
+
+#include <numeric/FixedPoint.hpp>
+#include <numeric/FixedPointTraits.hpp>
+#include <waveforms/SineLookup.hpp>
+#include <waveforms/PhaseAccumulator.hpp>
+#include <cstdint>
+
+namespace Drivers {
+
+  /**
+   * Streaming sine generator (numerically controlled oscillator).
+   *
+   * Where SineGenerator::calculateSine(t) takes an absolute time and has to wrap it against the period on
+   * every call, the oscillator keeps the phase as a 32 bit accumulator where 2^32 is one full period. Each
+   * sample is one add to the accumulator, two adjacent reads from the SineLookup table and a linear
+   * interpolation on the next 8 bits of phase. See PhaseAccumulator for how the period wraps without drift.
+   */
+  template<typename FP>
+  class SineOscillator {
+    private:
+      static constexpr uint32_t INDEX_SHIFT = 24;
+      static constexpr uint32_t FRACTION_SHIFT = 16;
+      static constexpr uint32_t FRACTION_MASK = 0xFF;
+
+      using LookupType = decltype(waveforms::SineLookup::calculateSine(0));
+      static constexpr int32_t LOOKUP_FRACTION = numeric::FractionBits<LookupType>::value;
+
+      PhaseAccumulator _phase;
+
+    public:
+      /**
+       * Oscillator producing exactly samplesPerPeriod samples for each period of the sine wave.
+       * samplesPerPeriod must not be zero.
+       */
+      explicit SineOscillator(uint32_t samplesPerPeriod) :
+              _phase(samplesPerPeriod) {
+      }
+
+      /**
+       * Oscillator for a sine wave of the given period sampled every sampleTime.
+       */
+      SineOscillator(FP period, FP sampleTime) :
+              _phase(static_cast<uint32_t>(sampleTime.asRaw()), static_cast<uint32_t>(period.asRaw())) {
+      }
+
+      /**
+       * Restart the waveform at the given phase (2^32 is a full period).
+       */
+      void reset(uint32_t phase = 0) {
+        _phase.reset(phase);
+      }
+
+      uint32_t phase() const {
+        return _phase.phase();
+      }
+
+      /**
+       * The value of the sine wave at the current phase.
+       */
+      FP current() const {
+        const int32_t index = static_cast<int32_t>(_phase.phase() >> INDEX_SHIFT);
+        const int32_t fraction = static_cast<int32_t>((_phase.phase() >> FRACTION_SHIFT) & FRACTION_MASK);
+        const int32_t a = waveforms::SineLookup::calculateSine(index).asRaw();
+        const int32_t b = waveforms::SineLookup::calculateSine(index + 1).asRaw();
+        return numeric::fromRaw<FP, LOOKUP_FRACTION>(a + (((b - a) * fraction) >> 8));
+      }
+
+      /**
+       * Move on to the next sample.
+       */
+      void advance() {
+        _phase.advance();
+      }
+
+      /**
+       * Return the current sample and advance to the next one.
+       */
+      FP next() {
+        FP result = current();
+        advance();
+        return result;
+      }
+
+      /**
+       * Fill a buffer with the next count samples.
+       */
+      void fill(FP *buffer, uint32_t count) {
+        for( uint32_t i = 0; i < count; i++ ) {
+          buffer[i] = next();
+        }
+      }
+  };
+
+}
+
+#endif
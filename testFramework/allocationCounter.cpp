@@ -0,0 +1,72 @@
+#include <testFramework/NoAllocationScope.hpp>
+#include <SolexOs/memory/SmallHeap.hpp>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+/**
+ * Heap operation counting for NoAllocationScope.
+ *
+ * The SmallHeap functions are wrapped by the linker, which needs the linker flags
+ *   -Wl,--wrap=_ZN6memory18allocateSmallBlockEj -Wl,--wrap=_ZN6memory14freeSmallBlockEPh
+ * Calls to them are then routed to the __wrap_ functions below and the originals are reached as __real_.
+ */
+static_assert(std::is_same<decltype(&memory::allocateSmallBlock), uint8_t *(*)(uint32_t)>::value,
+    "the wrapped symbol name assumes uint8_t *allocateSmallBlock(uint32_t)");
+static_assert(std::is_same<decltype(&memory::freeSmallBlock), void (*)(uint8_t *)>::value,
+    "the wrapped symbol name assumes void freeSmallBlock(uint8_t *)");
+
+namespace {
+  thread_local AllocationCounts counts = {0, 0, 0, 0};
+}
+
+AllocationCounts allocationCounts() {
+  return counts;
+}
+
+extern "C" {
+  uint8_t *__real__ZN6memory18allocateSmallBlockEj(uint32_t size);
+  void __real__ZN6memory14freeSmallBlockEPh(uint8_t *block);
+
+  uint8_t *__wrap__ZN6memory18allocateSmallBlockEj(uint32_t size) {
+    counts.smallAllocations++;
+    return __real__ZN6memory18allocateSmallBlockEj(size);
+  }
+
+  void __wrap__ZN6memory14freeSmallBlockEPh(uint8_t *block) {
+    counts.smallFrees++;
+    __real__ZN6memory14freeSmallBlockEPh(block);
+  }
+}
+
+void *operator new(std::size_t size) {
+  counts.newCalls++;
+  void *memory = std::malloc(size == 0 ? 1 : size);
+  if( memory == nullptr ) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+  if( memory != nullptr ) {
+    counts.deleteCalls++;
+  }
+  std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+  operator delete(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+  operator delete(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+  operator delete(memory);
+}
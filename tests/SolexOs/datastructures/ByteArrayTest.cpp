@@ -2,6 +2,10 @@
 #include <utils/elements.hpp>
 #include <SolexOs/datastructures/ByteArray.hpp>
 #include <testFramework/memoryLeaks.hpp>
+#include <testFramework/NoAllocationScope.hpp>
+
+#include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -76,4 +80,48 @@ TEST(ByteArrayTest, testEquals){
   EXPECT_FALSE(array1 == array2);
 }
 
+static ByteArray createArray(uint8_t first) {
+  ByteArray array(10);
+  array[0] = first;
+  return array;
+}
+
+TEST(ByteArrayTest, testMoveDoesNotCopy){
+  auto before = allocationCounts();
+  ByteArray array = createArray(1);
+  EXPECT_EQ((allocationCounts() - before).smallAllocations, 1u);
+
+  ByteArray moved;
+  {
+    NoAllocationScope noAllocation;
+    ByteArray temporary(std::move(array));
+    moved = std::move(temporary);
+  }
+  EXPECT_EQ(moved.getLength(), 10u);
+  EXPECT_EQ(moved[0], 1u);
+
+  ByteArray other = createArray(2);
+  {
+    NoAllocationScope noAllocation;
+    std::swap(moved, other);
+  }
+  EXPECT_EQ(moved[0], 2u);
+  EXPECT_EQ(other[0], 1u);
+}
 
+TEST(ByteArrayTest, testContainerMoves){
+  std::vector<ByteArray> arrays;
+  arrays.reserve(4);
+  auto before = allocationCounts();
+  for( uint8_t i = 0; i < 4; i++ ) {
+    arrays.push_back(createArray(i));
+  }
+  // growing the vector moves the arrays already in it
+  arrays.emplace_back(createArray(4));
+  EXPECT_EQ((allocationCounts() - before).smallAllocations, 5u);
+  for( uint8_t i = 0; i < 5; i++ ) {
+    EXPECT_EQ(arrays[i][0], i);
+  }
+  arrays.clear();
+  checkForLeaks();
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <SolexOs/datastructures/ByteArray.hpp>
+#include <SolexOs/datastructures/ByteSpan.hpp>
+#include <testFramework/memoryLeaks.hpp>
+
+#include <gtest/gtest.h>
+
+using SolexOs::ByteArray;
+
+constexpr auto MAX_ALLOC = memory::LARGE - 1;
+
+TEST(ByteSpanTest, validatedAccess){
+  ByteArray array(MAX_ALLOC);
+  auto span = SolexOs::validatedSpan(array);
+  EXPECT_EQ(span.size(), MAX_ALLOC);
+  for( uint32_t i = 0; i < span.size(); i++ ) {
+    span[i] = static_cast<uint8_t>(i + 1);
+  }
+  for( uint32_t i = 0; i < MAX_ALLOC; i++ ) {
+    EXPECT_EQ(array[i], static_cast<uint8_t>(i + 1));
+  }
+
+  auto part = SolexOs::validatedSpan(array, 10, 5);
+  EXPECT_EQ(part[0], 11u);
+  EXPECT_EQ(part.subspan(1, 2)[1], 13u);
+}
+
+TEST(ByteSpanTest, rangeChecked){
+  ByteArray array(8);
+  EXPECT_NO_THROW(SolexOs::validatedSpan(array, 0, 8));
+  EXPECT_NO_THROW(SolexOs::validatedSpan(array, 8, 0));
+  EXPECT_THROW(SolexOs::validatedSpan(array, 0, 9), std::system_error);
+  EXPECT_THROW(SolexOs::validatedSpan(array, 4, 5), std::system_error);
+  EXPECT_THROW(SolexOs::validatedSpan(array, 0xFFFFFFFFu, 2), std::system_error);
+
+  ByteArray empty(0);
+  EXPECT_EQ(SolexOs::validatedSpan(empty).size(), 0u);
+}
+
+TEST(ByteSpanTest, constArray){
+  ByteArray array(4);
+  array[2] = 7;
+  const ByteArray &constant = array;
+  auto span = SolexOs::validatedSpan(constant, 1, 3);
+  static_assert(std::is_same<decltype(span), SolexOs::ConstByteSpan>::value, "a const array gives a const span");
+  EXPECT_EQ(span.data(), &array[1]);
+  EXPECT_EQ(span[1], 7u);
+  EXPECT_THROW(SolexOs::validatedSpan(constant, 2, 3), std::system_error);
+}
+
+TEST(ByteSpanTest, streams){
+  ByteArray array(11);
+  SolexOs::SpanWriteStream writer(SolexOs::validatedSpan(array, 1, 10));
+  writer.write(uint32_t(0x12345678));
+  writer.write(int16_t(-2));
+  EXPECT_EQ(writer.bytesLeft(), 4u);
+  writer.write(1.5f);
+  EXPECT_EQ(writer.bytesLeft(), 0u);
+
+  const ByteArray &constant = array;
+  SolexOs::SpanReadStream reader(SolexOs::validatedSpan(constant, 1, 10));
+  uint32_t word;
+  int16_t half;
+  float real;
+  reader.read(word);
+  reader.read(half);
+  EXPECT_EQ(reader.bytesLeft(), 4u);
+  reader.read(real);
+  EXPECT_EQ(word, 0x12345678u);
+  EXPECT_EQ(half, -2);
+  EXPECT_EQ(real, 1.5f);
+  EXPECT_EQ(reader.bytesLeft(), 0u);
+  EXPECT_EQ(array[0], 0u);
+}
+
+TEST(ByteSpanTest, DISABLED_checkedVersusUnchecked){
+  constexpr uint32_t REPEATS = 10000;
+  ByteArray array(MAX_ALLOC);
+  uint32_t sum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for( uint32_t repeat = 0; repeat < REPEATS; repeat++ ) {
+    for( uint32_t i = 0; i < MAX_ALLOC; i++ ) {
+      array[i] = static_cast<uint8_t>(array[i] + i);
+    }
+    sum += array[repeat % MAX_ALLOC];
+  }
+  std::chrono::duration<double, std::nano> checked = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for( uint32_t repeat = 0; repeat < REPEATS; repeat++ ) {
+    auto span = SolexOs::validatedSpan(array);
+    for( uint32_t i = 0; i < span.size(); i++ ) {
+      span[i] = static_cast<uint8_t>(span[i] + i);
+    }
+    sum += array[repeat % MAX_ALLOC];
+  }
+  std::chrono::duration<double, std::nano> unchecked = std::chrono::steady_clock::now() - start;
+
+  std::cout << MAX_ALLOC << " bytes: checked " << checked.count() / REPEATS << " ns, span "
+            << unchecked.count() / REPEATS << " ns (" << sum << ")" << std::endl;
+}
@@ -1,9 +1,11 @@
 #include <cstdint>
 #include <SolexOs/datastructures/LinkedList.hpp>
 #include <testFramework/memoryLeaks.hpp>
+#include <testFramework/NoAllocationScope.hpp>
 #include <SolexOs/datastructures/ByteArray.hpp>
 
 #include <gtest/gtest.h>
+#include <utility>
 
 struct TestObj {
     uint32_t _a;
@@ -159,6 +161,20 @@ TEST(LinkedListTest, testMemoryAllocation) {
   checkForLeaks();
 }
 
+TEST(LinkedListTest, testIterationDoesNotAllocate) {
+  SolexOs::LinkedList<TestObj> list = createList();
+
+  NoAllocationScope noAllocation;
+  uint32_t sum = 0;
+  for( const TestObj &obj : list ) {
+    sum += obj._a;
+  }
+  for( const TestObj &obj : list.filter([](const TestObj &obj) {return (obj._a>3);}) ) {
+    sum += obj._b;
+  }
+  EXPECT_EQ(sum, 16u + 14u);
+}
+
 TEST(LinkedListTest, testSerialization) {
   SolexOs::LinkedList<TestObj> list = createList();
   EXPECT_EQ(list.streamSize(), 4U * (4U * 2U) + 1U);
@@ -173,3 +189,29 @@ TEST(LinkedListTest, testSerialization) {
   verifyList(newList);
 }
 
+TEST(LinkedListTest, testMoveDoesNotCopy) {
+  auto before = allocationCounts();
+  {
+    SolexOs::LinkedList<TestObj> list;
+    for( uint32_t i = 0; i < 4; i++ ) {
+      list.pushBack(testData[i]);
+    }
+  }
+  auto inPlace = allocationCounts() - before;
+
+  // returning by value costs no more than building in place
+  before = allocationCounts();
+  SolexOs::LinkedList<TestObj> list = createList();
+  EXPECT_EQ((allocationCounts() - before).smallAllocations, inPlace.smallAllocations);
+
+  SolexOs::LinkedList<TestObj> moved;
+  SolexOs::LinkedList<TestObj> other;
+  {
+    NoAllocationScope noAllocation;
+    SolexOs::LinkedList<TestObj> temporary(std::move(list));
+    moved = std::move(temporary);
+    std::swap(moved, other);
+  }
+  verifyList(other);
+  EXPECT_EQ(moved.size(), 0u);
+}
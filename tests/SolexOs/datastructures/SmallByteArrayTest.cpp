@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <utils/elements.hpp>
+#include <SolexOs/datastructures/SmallByteArray.hpp>
+#include <SolexOs/memory/SizeClassHeap.hpp>
+#include <testFramework/memoryLeaks.hpp>
+#include <testFramework/NoAllocationScope.hpp>
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using SolexOs::ByteArray;
+using SolexOs::SmallByteArray;
+
+namespace {
+  // the testEncode payload
+  uint8_t PAYLOAD[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xFE, 0xFF, 0xFD, 0xFF, 0xFF, 0xFF};
+
+  using MessageHeap = memory::SizeClassHeap<memory::SizeClass<64, 2>, memory::SizeClass<512, 1>>;
+  MessageHeap messageHeap;
+  using MessageArray = SmallByteArray<16, memory::HeapBlocks<MessageHeap, messageHeap>>;
+}
+
+TEST(SmallByteArrayTest, shortArraysDoNotAllocate){
+  {
+    NoAllocationScope noAllocation;
+    SmallByteArray<> payload(PAYLOAD, elements(PAYLOAD));
+    SmallByteArray<> record(8);
+    EXPECT_TRUE(payload.isInline());
+    EXPECT_TRUE(record.isInline());
+
+    EXPECT_EQ(payload, ByteArray(PAYLOAD, elements(PAYLOAD)));
+    EXPECT_EQ(payload[12], 0xFFu);
+    EXPECT_EQ(record.getLength(), 8u);
+  }
+  checkForLeaks();
+
+  SmallByteArray<> payload(PAYLOAD, elements(PAYLOAD));
+  EXPECT_THROW(payload[13] = 1, std::system_error);
+}
+
+TEST(SmallByteArrayTest, longArraysUseTheHeap){
+  auto before = allocationCounts();
+  {
+    SmallByteArray<16> array(17);
+    EXPECT_FALSE(array.isInline());
+    EXPECT_EQ((allocationCounts() - before).smallAllocations, 1u);
+    array[16] = 3;
+    EXPECT_EQ(array[16], 3u);
+    EXPECT_THROW(array[17] = 1, std::system_error);
+  }
+  EXPECT_EQ((allocationCounts() - before).smallFrees, 1u);
+  EXPECT_THROW(SmallByteArray<16> tooLong(memory::LARGE + 1), std::system_error);
+  checkForLeaks();
+}
+
+TEST(SmallByteArrayTest, streams){
+  SmallByteArray<> record(8);
+  {
+    NoAllocationScope noAllocation;
+    auto writer = record.getWriteStream();
+    writer.write(0x12345678u);
+    writer.write(0x9ABCDEF0u);
+
+    auto reader = record.getReadStream();
+    EXPECT_EQ(reader.bytesLeft(), 8u);
+    uint32_t first;
+    uint32_t second;
+    reader.read(first);
+    reader.read(second);
+    EXPECT_EQ(first, 0x12345678u);
+    EXPECT_EQ(second, 0x9ABCDEF0u);
+    EXPECT_EQ(reader.bytesLeft(), 0u);
+  }
+  auto writer = record.getWriteStream();
+  writer.write(uint64_t(0));
+  EXPECT_THROW(writer.write(uint8_t(1)), std::system_error);
+  auto reader = record.getReadStream();
+  uint64_t whole;
+  uint8_t past;
+  reader.read(whole);
+  EXPECT_THROW(reader.read(past), std::system_error);
+  checkForLeaks();
+}
+
+TEST(SmallByteArrayTest, setLength){
+  SmallByteArray<> payload(PAYLOAD, elements(PAYLOAD));
+  payload.setLength(4);
+  EXPECT_EQ(payload.getLength(), 4u);
+  EXPECT_THROW(payload[4] = 1, std::system_error);
+  EXPECT_EQ(payload.getReadStream().bytesLeft(), 4u);
+
+  payload.setLength(elements(PAYLOAD));
+  EXPECT_EQ(payload, ByteArray(PAYLOAD, elements(PAYLOAD)));
+  EXPECT_THROW(payload.setLength(elements(PAYLOAD) + 1), std::system_error);
+}
+
+TEST(SmallByteArrayTest, equality){
+  SmallByteArray<> inlined(PAYLOAD, elements(PAYLOAD));
+  SmallByteArray<4> onHeap(PAYLOAD, elements(PAYLOAD));
+  EXPECT_TRUE(inlined == onHeap.array());
+
+  SmallByteArray<> other(PAYLOAD, elements(PAYLOAD));
+  EXPECT_EQ(inlined, other);
+  other[0] = 0;
+  EXPECT_FALSE(inlined == other);
+  other[0] = PAYLOAD[0];
+  other.setLength(12);
+  EXPECT_FALSE(inlined == other);
+}
+
+TEST(SmallByteArrayTest, moves){
+  {
+    SmallByteArray<> payload(PAYLOAD, elements(PAYLOAD));
+    payload.setLength(10);
+    SmallByteArray<> heap(200);
+    heap[199] = 9;
+    SmallByteArray<> moved;
+    SmallByteArray<> target;
+    {
+      NoAllocationScope noAllocation;
+      moved = std::move(payload);
+      EXPECT_EQ(moved.getLength(), 10u);
+      EXPECT_EQ(moved[9], PAYLOAD[9]);
+      EXPECT_EQ(payload.getLength(), 0u);
+      // the moved array has its own inline bytes and keeps its capacity
+      moved[0] = 0x55;
+      moved.setLength(elements(PAYLOAD));
+      EXPECT_EQ(moved[12], PAYLOAD[12]);
+
+      SmallByteArray<> temporary(std::move(heap));
+      target = std::move(temporary);
+      EXPECT_FALSE(target.isInline());
+      EXPECT_EQ(target[199], 9u);
+    }
+    // replacing a heap array returns its block
+    target = std::move(moved);
+    EXPECT_TRUE(target.isInline());
+    EXPECT_EQ(target[0], 0x55u);
+  }
+  checkForLeaks();
+
+  std::vector<SmallByteArray<>> arrays;
+  for( uint8_t i = 0; i < 8; i++ ) {
+    arrays.emplace_back(8);
+    arrays.back()[0] = i;
+  }
+  for( uint8_t i = 0; i < 8; i++ ) {
+    EXPECT_EQ(arrays[i][0], i);
+  }
+  arrays.clear();
+  checkForLeaks();
+}
+
+TEST(SmallByteArrayTest, sizeClassHeap){
+  {
+    NoAllocationScope noAllocation;
+    MessageArray large(400);
+    EXPECT_FALSE(large.isInline());
+    EXPECT_EQ(messageHeap.freeSpace(1), 0u);
+    large[399] = 4;
+    auto writer = large.getWriteStream();
+    writer.write(0x12345678u);
+
+    MessageArray moved(std::move(large));
+    EXPECT_EQ(moved[399], 4u);
+    EXPECT_EQ(moved.getReadStream().bytesLeft(), 400u);
+    MessageArray payload(PAYLOAD, elements(PAYLOAD));
+    EXPECT_TRUE(payload.isInline());
+    EXPECT_EQ(messageHeap.freeSpace(0), 2u);
+  }
+  EXPECT_EQ(messageHeap.freeSpace(1), 1u);
+  EXPECT_THROW(MessageArray tooLong(513), std::system_error);
+  EXPECT_EQ(messageHeap.freeSpace(0), 2u);
+}
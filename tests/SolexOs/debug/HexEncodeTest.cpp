@@ -0,0 +1,140 @@
+#include <SolexOs/Debug.h>
+#include <SolexOs/debug/HexEncode.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" uint8_t convertToHex(uint32_t num);
+
+namespace {
+  /**
+   * DBG_SendBuffer as it was, nibble by nibble.
+   */
+  std::string referenceBuffer(uint32_t len, const uint8_t *buff) {
+    std::string out;
+    while( len > 0 ) {
+      uint32_t segment = len > 16 ? 16 : len;
+      for( uint32_t i = 0; i < segment; ++i ) {
+        out += static_cast<char>(convertToHex(*buff >> 4));
+        out += static_cast<char>(convertToHex(*buff));
+        buff++;
+      }
+      out += ' ';
+      len = len - segment;
+    }
+    return out;
+  }
+
+  /**
+   * DBG_SendNumber as it was, digit by digit.
+   */
+  std::string referenceNumber(uint8_t size, uint64_t num) {
+    uint32_t digits = size * 2;
+    if( digits > 16 ) {
+      digits = 16;
+    }
+    std::string out;
+    for( uint32_t i = 0; i < digits; ++i ) {
+      out += static_cast<char>(convertToHex((num >> (digits - 1 - i) * 4) & 0xF));
+    }
+    return out;
+  }
+
+  std::vector<uint8_t> randomBytes(std::mt19937 &random, size_t length) {
+    std::vector<uint8_t> bytes(length);
+    for( auto &byte : bytes ) {
+      byte = static_cast<uint8_t>(random());
+    }
+    return bytes;
+  }
+}
+
+TEST(HexEncodeTest, EveryByte) {
+  uint8_t bytes[256];
+  for( uint32_t i = 0; i < 256; i++ ) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+  char out[512];
+  SolexOs::Trace::encodeHex(bytes, sizeof(bytes), out);
+  for( uint32_t i = 0; i < 256; i++ ) {
+    EXPECT_EQ(out[2 * i], static_cast<char>(convertToHex(i >> 4)));
+    EXPECT_EQ(out[2 * i + 1], static_cast<char>(convertToHex(i)));
+  }
+}
+
+/**
+ * Each encoder against the table, so the path this machine does not take is still checked.
+ */
+TEST(HexEncodeTest, PathsMatchTable) {
+  std::mt19937 random(11);
+  for( uint32_t length : {0u, 3u, 4u, 15u, 16u, 17u, 32u, 100u, 1500u} ) {
+    auto bytes = randomBytes(random, length);
+    std::string expected(2 * length, ' ');
+    SolexOs::Trace::Hex::encodeTable(bytes.data(), length, &expected[0]);
+
+    std::string words(2 * length, ' ');
+    SolexOs::Trace::Hex::encodeWords(bytes.data(), length, &words[0]);
+    EXPECT_EQ(words, expected) << "length " << length;
+
+#if defined(HEX_ENCODE_SSSE3)
+    if( SolexOs::Trace::Hex::hasSsse3() ) {
+      std::string blocks(2 * length, ' ');
+      const size_t encoded = SolexOs::Trace::Hex::encodeBlocks(bytes.data(), length, &blocks[0]);
+      EXPECT_EQ(encoded, length - length % 16);
+      EXPECT_EQ(blocks.substr(0, 2 * encoded), expected.substr(0, 2 * encoded)) << "length " << length;
+      EXPECT_EQ(blocks.substr(2 * encoded), std::string(2 * (length - encoded), ' ')) << "length " << length;
+    }
+#endif
+
+    std::string hex(2 * length, ' ');
+    SolexOs::Trace::encodeHex(bytes.data(), length, &hex[0]);
+    EXPECT_EQ(hex, expected) << "length " << length;
+  }
+}
+
+TEST(HexEncodeTest, BufferMatchesReference) {
+  std::mt19937 random(17);
+  for( uint32_t length : {0u, 1u, 3u, 4u, 15u, 16u, 17u, 33u, 100u, 255u, 256u, 257u, 1500u} ) {
+    auto bytes = randomBytes(random, length);
+    testing::internal::CaptureStdout();
+    DBG_SendBuffer(0, 0, length, bytes.data());
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), referenceBuffer(length, bytes.data())) << "length " << length;
+  }
+}
+
+TEST(HexEncodeTest, NumberMatchesReference) {
+  std::mt19937_64 random(5);
+  for( uint8_t size = 0; size <= 10; size++ ) {
+    for( uint64_t value : {uint64_t(0), ~uint64_t(0), uint64_t(0x0123456789ABCDEF), uint64_t(random())} ) {
+      testing::internal::CaptureStdout();
+      DBG_SendNumber(0, 0, size, value);
+      EXPECT_EQ(testing::internal::GetCapturedStdout(), referenceNumber(size, value)) << "size " << int(size);
+    }
+  }
+}
+
+TEST(HexEncodeTest, DISABLED_EncodeCost) {
+  std::mt19937 random(3);
+  auto bytes = randomBytes(random, 4096);
+  std::vector<char> out(2 * bytes.size());
+  constexpr uint32_t REPEATS = 1000;
+  auto start = std::chrono::steady_clock::now();
+  for( uint32_t i = 0; i < REPEATS; i++ ) {
+    SolexOs::Trace::encodeHex(bytes.data(), bytes.size(), out.data());
+  }
+  auto encoded = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for( uint32_t i = 0; i < REPEATS; i++ ) {
+    for( size_t j = 0; j < bytes.size(); j++ ) {
+      out[2 * j] = static_cast<char>(convertToHex(bytes[j] >> 4));
+      out[2 * j + 1] = static_cast<char>(convertToHex(bytes[j]));
+    }
+  }
+  auto reference = std::chrono::steady_clock::now() - start;
+  std::cout << "ns per byte encodeHex "
+      << std::chrono::duration<double, std::nano>(encoded).count() / (REPEATS * bytes.size()) << " nibble loop "
+      << std::chrono::duration<double, std::nano>(reference).count() / (REPEATS * bytes.size()) << std::endl;
+}
@@ -0,0 +1,73 @@
+#include <SolexOs/debug/TraceFilter.hpp>
+#include <SolexOs/debug/TraceTokens.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+  constexpr uint32_t MOTOR = 3;
+  constexpr uint32_t NETWORK = 7;
+}
+
+TRACE_MODULE_LEVEL(MOTOR, SolexOs::Trace::LEVEL_WARNING);
+TRACE_MODULE_LEVEL(NETWORK, SolexOs::Trace::LEVEL_NONE);
+
+namespace {
+  uint32_t evaluations = 0;
+
+  uint64_t counted(uint64_t value) {
+    evaluations++;
+    return value;
+  }
+
+  /**
+   * Run the trace sites and return how many DBG_* calls they made, one binary record per call.
+   */
+  template<typename SITES>
+  size_t callsMade(SITES sites) {
+    std::vector<uint8_t> log(256);
+    SolexOs::Trace::setBinaryLog(log.data(), static_cast<uint32_t>(log.size()));
+    sites();
+    SolexOs::Trace::setBinaryLog(nullptr, 0);
+    // every record here is a number of size 4
+    return SolexOs::Trace::binaryLogLength() / (2 + 4);
+  }
+
+  void motorSites() {
+    TRACE_SEND_NUMBER(MOTOR, SolexOs::Trace::LEVEL_ERROR, 4, counted(1));
+    TRACE_SEND_NUMBER(MOTOR, SolexOs::Trace::LEVEL_WARNING, 4, counted(2));
+    TRACE_SEND_NUMBER(MOTOR, SolexOs::Trace::LEVEL_INFO, 4, counted(3));
+    TRACE_SEND_NUMBER(MOTOR, SolexOs::Trace::LEVEL_DEBUG, 4, counted(4));
+  }
+}
+
+TEST(TraceFilterTest, CompileTimeLevels) {
+  static_assert(SolexOs::Trace::compiledIn<MOTOR, SolexOs::Trace::LEVEL_WARNING>(), "");
+  static_assert(!SolexOs::Trace::compiledIn<MOTOR, SolexOs::Trace::LEVEL_INFO>(), "");
+  static_assert(!SolexOs::Trace::compiledIn<NETWORK, SolexOs::Trace::LEVEL_ERROR>(), "");
+  static_assert(SolexOs::Trace::compiledIn<0, SolexOs::Trace::LEVEL_DEBUG>(), "");
+}
+
+TEST(TraceFilterTest, DisabledSitesMakeNoCalls) {
+  evaluations = 0;
+  EXPECT_EQ(callsMade(motorSites), 2u);
+  EXPECT_EQ(evaluations, 2u);
+
+  evaluations = 0;
+  EXPECT_EQ(callsMade([]() {
+    TRACE_SEND_NUMBER(NETWORK, SolexOs::Trace::LEVEL_ERROR, 4, counted(5));
+  }), 0u);
+  EXPECT_EQ(evaluations, 0u);
+}
+
+TEST(TraceFilterTest, RuntimeMask) {
+  evaluations = 0;
+  DBG_ConfigDebug(~(1u << MOTOR));
+  EXPECT_EQ(callsMade(motorSites), 0u);
+  EXPECT_EQ(evaluations, 0u);
+  EXPECT_EQ(callsMade([]() {
+    TRACE_SEND_NUMBER(0, SolexOs::Trace::LEVEL_DEBUG, 4, counted(6));
+  }), 1u);
+
+  DBG_ConfigDebug(0xFFFFFFFF);
+  EXPECT_EQ(callsMade(motorSites), 2u);
+}
@@ -0,0 +1,214 @@
+#include <SolexOs/Debug.h>
+#include <SolexOs/debug/TraceRing.hpp>
+#include <SolexOs/debug/TraceTokens.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SolexOs::Trace::TraceRing;
+
+namespace {
+  void emitTrace() {
+    for( uint32_t i = 0; i < 20; i++ ) {
+      DBG_SendString(1, 2, reinterpret_cast<const uint8_t *>("emitTrace"), reinterpret_cast<const uint8_t *>("count"));
+      DBG_Space(1, 2);
+      DBG_SendNumber(1, 2, 4, i);
+      DBG_SendRawString(1, 2, "\n");
+    }
+  }
+
+  double nsPerCall(uint32_t calls) {
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < calls; i++ ) {
+      DBG_SendNumber(1, 2, 4, i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / calls;
+  }
+}
+
+TEST(TraceRingTest, DrainsInOrder) {
+  TraceRing<8, 12> ring;
+  static_assert(TraceRing<8, 12>::TEXT_SIZE == 8, "slots hold 8 bytes of text after their length");
+  EXPECT_TRUE(ring.push("hello ", 6));
+  EXPECT_TRUE(ring.push("a longer record", 15));
+  std::string out;
+  EXPECT_EQ(ring.drain([&](const char *text, size_t length) {out.append(text, length);}), 3u);
+  EXPECT_EQ(out, "hello a longer record");
+  EXPECT_EQ(ring.drain([&](const char *text, size_t length) {out.append(text, length);}), 0u);
+}
+
+TEST(TraceRingTest, CountsDrops) {
+  TraceRing<4, 8> ring;
+  for( uint32_t i = 0; i < 6; i++ ) {
+    ring.push("x", 1);
+  }
+  EXPECT_EQ(ring.dropped(), 2u);
+  std::string out;
+  ring.drain([&](const char *text, size_t length) {out.append(text, length);});
+  EXPECT_EQ(out, "xxxx");
+  EXPECT_TRUE(ring.push("y", 1));
+  ring.resetDropped();
+  EXPECT_EQ(ring.dropped(), 0u);
+}
+
+TEST(TraceRingTest, WholeRecordsOrNothing) {
+  TraceRing<4, 8> ring;
+  EXPECT_TRUE(ring.push("0123456789", 10));
+  // needs two slots with one free, so none of it goes in
+  EXPECT_FALSE(ring.push("abcdefgh", 8));
+  EXPECT_FALSE(ring.push("far more than the whole ring", 28));
+  EXPECT_EQ(ring.dropped(), 2u);
+
+  std::string out;
+  std::vector<uint32_t> left;
+  ring.drain([&](const char *text, size_t length, uint32_t bytesLeft) {
+    out.append(text, length);
+    left.push_back(bytesLeft);
+  });
+  EXPECT_EQ(out, "0123456789");
+  EXPECT_EQ(left, (std::vector<uint32_t> {10, 6, 2}));
+
+  const TraceRing<4, 8>::Part parts[] = {{"ab", 2}, {"", 0}, {"cdefg", 5}};
+  EXPECT_TRUE(ring.push(parts, 3));
+  out.clear();
+  ring.drain([&](const char *text, size_t length) {out.append(text, length);});
+  EXPECT_EQ(out, "abcdefg");
+}
+
+TEST(TraceRingTest, ManyProducers) {
+  constexpr uint32_t PRODUCERS = 4;
+  constexpr uint32_t RECORDS = 5000;
+  // each record spans two slots
+  static TraceRing<256, 8> ring;
+  std::atomic<bool> done(false);
+  std::vector<uint32_t> next(PRODUCERS, 0);
+  bool ordered = true;
+  uint32_t received = 0;
+  std::string record;
+  auto sink = [&](const char *text, size_t length, uint32_t left) {
+    ASSERT_TRUE(record.empty() ? left == 5u : left == 5u - record.size());
+    record.append(text, length);
+    if( record.size() < 5 ) {
+      return;
+    }
+    uint32_t producer = static_cast<uint8_t>(record[0]);
+    uint32_t sequence;
+    std::memcpy(&sequence, record.data() + 1, sizeof(sequence));
+    ordered = ordered && (sequence == next[producer]);
+    next[producer] = sequence + 1;
+    record.clear();
+    received++;
+  };
+  std::thread consumer([&]() {
+    while( !done.load() ) {
+      ring.drain(sink);
+    }
+    ring.drain(sink);
+  });
+  std::vector<std::thread> producers;
+  for( uint32_t p = 0; p < PRODUCERS; p++ ) {
+    producers.emplace_back([p]() {
+      char record[5];
+      record[0] = static_cast<char>(p);
+      for( uint32_t i = 0; i < RECORDS; i++ ) {
+        std::memcpy(record + 1, &i, sizeof(i));
+        while( !ring.push(record, sizeof(record)) ) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for( auto &producer : producers ) {
+    producer.join();
+  }
+  done.store(true);
+  consumer.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(received, PRODUCERS * RECORDS);
+}
+
+TEST(TraceRingTest, SameTextAsDirect) {
+  testing::internal::CaptureStdout();
+  emitTrace();
+  std::string direct = testing::internal::GetCapturedStdout();
+
+  testing::internal::CaptureStdout();
+  SolexOs::Trace::startRing();
+  emitTrace();
+  SolexOs::Trace::stopRing();
+  std::string buffered = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(SolexOs::Trace::droppedRecords(), 0u);
+  EXPECT_EQ(buffered, direct);
+}
+
+TEST(TraceRingTest, SameBinaryAsDirect) {
+  std::vector<uint8_t> direct(1024);
+  SolexOs::Trace::setBinaryLog(direct.data(), static_cast<uint32_t>(direct.size()));
+  emitTrace();
+  direct.resize(SolexOs::Trace::binaryLogLength());
+
+  std::vector<uint8_t> buffered(1024);
+  SolexOs::Trace::setBinaryLog(buffered.data(), static_cast<uint32_t>(buffered.size()));
+  SolexOs::Trace::startRing();
+  emitTrace();
+  SolexOs::Trace::stopRing();
+  buffered.resize(SolexOs::Trace::binaryLogLength());
+  SolexOs::Trace::setBinaryLog(nullptr, 0);
+  EXPECT_EQ(SolexOs::Trace::droppedRecords(), 0u);
+  EXPECT_EQ(buffered, direct);
+}
+
+/**
+ * Producers still tracing while the ring stops: every record is written, sent directly or counted as
+ * dropped, none is pushed after the final drain and lost.
+ */
+TEST(TraceRingTest, StopWaitsForProducers) {
+  constexpr uint32_t PRODUCERS = 4;
+  constexpr uint32_t RECORDS = 20000;
+  testing::internal::CaptureStdout();
+  SolexOs::Trace::startRing();
+  std::vector<std::thread> producers;
+  for( uint32_t p = 0; p < PRODUCERS; p++ ) {
+    producers.emplace_back([]() {
+      for( uint32_t i = 0; i < RECORDS; i++ ) {
+        DBG_SendNumber(1, 2, 4, i);
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  SolexOs::Trace::stopRing();
+  for( auto &producer : producers ) {
+    producer.join();
+  }
+  std::string out = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(out.size() / 8 + SolexOs::Trace::droppedRecords(), PRODUCERS * RECORDS);
+}
+
+TEST(TraceRingTest, StopsAtExit) {
+  EXPECT_EXIT({
+    std::freopen("/dev/null", "w", stdout);
+    SolexOs::Trace::startRing();
+    DBG_SendRawString(1, 2, "queued at exit");
+    std::exit(0);
+  }, testing::ExitedWithCode(0), "");
+}
+
+TEST(TraceRingTest, DISABLED_CallCost) {
+  constexpr uint32_t CALLS = 100000;
+  testing::internal::CaptureStdout();
+  double direct = nsPerCall(CALLS);
+  SolexOs::Trace::startRing();
+  double buffered = nsPerCall(CALLS);
+  SolexOs::Trace::stopRing();
+  testing::internal::GetCapturedStdout();
+  std::cout << "ns per DBG_SendNumber direct " << direct << " ring " << buffered << " dropped "
+      << SolexOs::Trace::droppedRecords() << std::endl;
+}
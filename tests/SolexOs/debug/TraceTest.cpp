@@ -0,0 +1,185 @@
+#include <SolexOs/Debug.h>
+#include <SolexOs/debug/TraceDecoder.hpp>
+#include <SolexOs/debug/TraceTokens.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using SolexOs::Trace::TokenTable;
+
+namespace {
+  const uint8_t FRAME[] = {0x00, 0x01, 0x7F, 0x80, 0xAB, 0xCD, 0xEF, 0xFF, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70,
+      0x80, 0x90, 0xA0, 0xB0};
+
+  /**
+   * A mix of every kind of trace call, as a driver would emit.
+   */
+  void emitTrace() {
+    DBG_SendString(1, 2, reinterpret_cast<const uint8_t *>("emitTrace"), reinterpret_cast<const uint8_t *>("start"));
+    DBG_Space(1, 2);
+    DBG_SendNumber(1, 2, 4, 0x12345678);
+    DBG_Space(1, 2);
+    DBG_SendNumber(1, 2, 1, 0xABCD);
+    DBG_Space(1, 2);
+    DBG_SendNumber(1, 2, 8, 0x0123456789ABCDEFull);
+    DBG_SendRawString(1, 2, "\n");
+    DBG_SendBuffer(1, 2, sizeof(FRAME), FRAME);
+    TRACE_STRING(1, 2, "emitTrace", "tokenised");
+  }
+
+  std::string textTrace() {
+    testing::internal::CaptureStdout();
+    emitTrace();
+    return testing::internal::GetCapturedStdout();
+  }
+
+  /**
+   * The binary log written by TRACE.
+   */
+  template<typename TRACE>
+  std::vector<uint8_t> binaryTrace(TRACE trace, uint32_t size = 1024) {
+    std::vector<uint8_t> log(size);
+    SolexOs::Trace::setBinaryLog(log.data(), size);
+    trace();
+    log.resize(SolexOs::Trace::binaryLogLength());
+    SolexOs::Trace::setBinaryLog(nullptr, 0);
+    return log;
+  }
+
+  std::string decode(const std::vector<uint8_t> &log, const TokenTable &table = TokenTable::linked()) {
+    return SolexOs::Trace::decode(log.data(), log.size(), table);
+  }
+
+  template<typename TRACE>
+  double nsPerCall(uint32_t calls, TRACE trace) {
+    auto start = std::chrono::steady_clock::now();
+    for( uint32_t i = 0; i < calls; i++ ) {
+      trace();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / calls;
+  }
+}
+
+TEST(TraceTest, TokensAreCompileTime) {
+  constexpr uint32_t token = SolexOs::Trace::tokenOf("start");
+  static_assert(token == SolexOs::Trace::tokenOf("start"), "token must be a constant");
+  EXPECT_NE(token, SolexOs::Trace::tokenOf("stop"));
+  EXPECT_EQ(TRACE_TOKEN("in the table"), SolexOs::Trace::tokenOf("in the table"));
+  EXPECT_STREQ(TokenTable::linked().lookup(SolexOs::Trace::tokenOf("in the table")), "in the table");
+}
+
+TEST(TraceTest, DecodeMatchesText) {
+  std::string text = textTrace();
+  EXPECT_EQ(text.substr(0, 45), "emitTrace:start 12345678 CD 0123456789ABCDEF\n");
+  EXPECT_EQ(decode(binaryTrace(emitTrace)), text);
+}
+
+TEST(TraceTest, BinaryIsSmaller) {
+  auto log = binaryTrace([]() {
+    for( int i = 0; i < 100; i++ ) {
+      TRACE_STRING(1, 2, "BinaryIsSmaller", "a message that is much longer than its token");
+      DBG_SendNumber(1, 2, 4, static_cast<uint64_t>(i));
+    }
+  }, 2048);
+  EXPECT_EQ(log.size(), 100u * (9u + 6u));
+  EXPECT_GT(decode(log).size(), 4 * log.size());
+}
+
+TEST(TraceTest, PointerStringsAreCopied) {
+  auto log = binaryTrace([]() {
+    DBG_SendString(1, 2, reinterpret_cast<const uint8_t *>("func"), reinterpret_cast<const uint8_t *>("msg"));
+  });
+  EXPECT_EQ(log.size(), 5u + 8u);
+  EXPECT_EQ(decode(log, TokenTable()), "func:msg");
+}
+
+TEST(TraceTest, FullLogDropsWholeRecords) {
+  auto log = binaryTrace([]() {
+    TRACE_STRING(1, 2, "FullLog", "first");
+    TRACE_STRING(1, 2, "FullLog", "second");
+    DBG_SendNumber(1, 2, 4, 0x12345678);
+    DBG_Space(1, 2);
+  }, 20);
+  EXPECT_EQ(SolexOs::Trace::binaryLogDropped(), 1u);
+  EXPECT_EQ(log.size(), 19u);
+  EXPECT_EQ(decode(log), "FullLog:firstFullLog:second ");
+}
+
+TEST(TraceTest, UnknownToken) {
+  auto log = binaryTrace([]() {
+    DBG_SendTokens(0, 0, 0x12345678, TRACE_TOKEN("known"), nullptr, nullptr);
+  });
+  EXPECT_EQ(decode(log), "<token 12345678>:known");
+
+  testing::internal::CaptureStdout();
+  DBG_SendTokens(0, 0, 0x12345678, 0x9ABCDEF0, nullptr, nullptr);
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "<token 12345678>:<token 9ABCDEF0>");
+}
+
+TEST(TraceTest, TableFromElf) {
+  std::ifstream file("/proc/self/exe", std::ios::binary);
+  std::vector<uint8_t> elf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ASSERT_FALSE(elf.empty());
+
+  TokenTable table;
+  EXPECT_TRUE(table.addElf(elf.data(), elf.size()));
+  EXPECT_STREQ(table.lookup(TRACE_TOKEN("read from the ELF")), "read from the ELF");
+  EXPECT_EQ(table.size(), TokenTable::linked().size());
+
+  const uint8_t notElf[64] = {'E', 'L', 'F'};
+  EXPECT_FALSE(TokenTable().addElf(notElf, sizeof(notElf)));
+}
+
+TEST(TraceTest, DetectsCollisions) {
+  using SolexOs::Trace::makeTokenRecord;
+  static_assert(SolexOs::Trace::tokenOf("costarring") == SolexOs::Trace::tokenOf("liquid"), "known FNV-1a pair");
+  struct {
+      SolexOs::Trace::TokenRecord<11> first;
+      SolexOs::Trace::TokenRecord<7> second;
+      SolexOs::Trace::TokenRecord<7> unique;
+      SolexOs::Trace::TokenRecord<7> repeated;
+  } section = {makeTokenRecord("costarring"), makeTokenRecord("liquid"), makeTokenRecord("unique"),
+      makeTokenRecord("unique")};
+
+  TokenTable table;
+  EXPECT_TRUE(table.addSection(reinterpret_cast<const uint8_t *>(&section), sizeof(section)));
+  EXPECT_EQ(table.size(), 2u);
+  ASSERT_EQ(table.collisions().size(), 1u);
+  EXPECT_EQ(table.collisions()[0], SolexOs::Trace::tokenOf("liquid"));
+  EXPECT_STREQ(table.lookup(SolexOs::Trace::tokenOf("liquid")), "costarring");
+
+  EXPECT_TRUE(TokenTable::linked().collisions().empty());
+}
+
+/**
+ * Cost of a trace call in each mode. Run with --gtest_also_run_disabled_tests.
+ */
+TEST(TraceTest, DISABLED_CallCost) {
+  constexpr uint32_t CALLS = 20000;
+  std::vector<uint8_t> log(1 << 20);
+  auto tokens = []() {
+    TRACE_STRING(1, 2, "CallCost", "a message of a typical length");
+  };
+  auto pointers = []() {
+    DBG_SendString(1, 2, reinterpret_cast<const uint8_t *>("CallCost"),
+        reinterpret_cast<const uint8_t *>("a message of a typical length"));
+  };
+
+  SolexOs::Trace::setBinaryLog(log.data(), static_cast<uint32_t>(log.size()));
+  double binaryTokens = nsPerCall(CALLS, tokens);
+  SolexOs::Trace::setBinaryLog(log.data(), static_cast<uint32_t>(log.size()));
+  double binaryPointers = nsPerCall(CALLS, pointers);
+  EXPECT_EQ(SolexOs::Trace::binaryLogDropped(), 0u);
+  SolexOs::Trace::setBinaryLog(nullptr, 0);
+
+  testing::internal::CaptureStdout();
+  double text = nsPerCall(CALLS, tokens);
+  testing::internal::GetCapturedStdout();
+  std::cout << "ns per string call: binary tokens " << binaryTokens << " binary pointers " << binaryPointers
+            << " text " << text << std::endl;
+}
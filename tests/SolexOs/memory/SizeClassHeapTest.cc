@@ -0,0 +1,116 @@
+#include <SolexOs/memory/SizeClassHeap.hpp>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <system_error>
+#include <vector>
+
+using TestHeap = memory::SizeClassHeap<memory::SizeClass<16, 4>, memory::SizeClass<48, 3>, memory::SizeClass<256, 2>>;
+
+static_assert(TestHeap::classFor(0) == 0, "");
+static_assert(TestHeap::classFor(16) == 0, "");
+static_assert(TestHeap::classFor(17) == 1, "");
+static_assert(TestHeap::classFor(48) == 1, "");
+static_assert(TestHeap::classFor(49) == 2, "");
+static_assert(TestHeap::classFor(256) == 2, "");
+static_assert(TestHeap::classFor(257) == TestHeap::NO_CLASS, "");
+static_assert(TestHeap::maxAllocation() == 256, "");
+
+
+template <uint32_t SIZE_CLASS>
+void testClassAlloc(TestHeap &heap) {
+  constexpr uint32_t SIZE = TestHeap::SIZES[SIZE_CLASS];
+  constexpr uint32_t BLOCKS = TestHeap::COUNTS[SIZE_CLASS];
+  EXPECT_EQ(heap.freeSpace(SIZE_CLASS), BLOCKS);
+  uint8_t *block[BLOCKS];
+  for( uint32_t i = 0; i < BLOCKS; i++){
+    block[i] = heap.allocate(SIZE);
+    ASSERT_NE(nullptr, block[i]);
+    EXPECT_TRUE(heap.owns(block[i]));
+    for( uint32_t j = 0; j < SIZE; j++ ) {
+      block[i][j] = static_cast<uint8_t>(i);
+    }
+  }
+  EXPECT_EQ(heap.freeSpace(SIZE_CLASS), 0u);
+  // exhausted classes do not spill into larger ones
+  EXPECT_THROW(heap.allocate(SIZE), std::system_error);
+  EXPECT_EQ(heap.tryAllocate(SIZE), nullptr);
+
+  for( uint32_t i = 0; i < BLOCKS; i++){
+    for( uint32_t j = 0; j < SIZE; j++ ) {
+      EXPECT_EQ(block[i][j], i);
+    }
+  }
+
+  for( uint32_t i = 0; i < BLOCKS*2; i++){
+    uint8_t *oldBlock = block[i%BLOCKS];
+    heap.free(block[i%BLOCKS]);
+    block[i%BLOCKS] = heap.allocate(SIZE);
+    EXPECT_EQ(oldBlock, block[i%BLOCKS]);
+  }
+
+  for( uint32_t i = 0; i < BLOCKS; i++){
+    heap.free(block[i]);
+  }
+  EXPECT_EQ(heap.freeSpace(SIZE_CLASS), BLOCKS);
+}
+
+
+TEST(SizeClassHeap, AllocAll){
+  TestHeap heap;
+  testClassAlloc<0>(heap);
+  testClassAlloc<1>(heap);
+  testClassAlloc<2>(heap);
+}
+
+
+TEST(SizeClassHeap, OverAllocate){
+  TestHeap heap;
+  EXPECT_THROW(heap.allocate(257), std::system_error);
+  EXPECT_EQ(heap.tryAllocate(257), nullptr);
+  std::vector<uint8_t *> blocks;
+  for( uint8_t *block = heap.tryAllocate(20); block != nullptr; block = heap.tryAllocate(20) ) {
+    blocks.push_back(block);
+  }
+  EXPECT_EQ(blocks.size(), 3u);
+  EXPECT_EQ(heap.freeSpace(0), 4u);
+  heap.reset();
+  EXPECT_EQ(heap.freeSpace(1), 3u);
+  EXPECT_FALSE(heap.owns(nullptr));
+}
+
+
+TEST(SizeClassHeap, FreeChecksPointer){
+  TestHeap heap;
+  uint8_t *small = heap.allocate(16);
+  uint8_t *medium = heap.allocate(48);
+  uint8_t foreign[16];
+
+  EXPECT_THROW(heap.free(foreign), std::system_error);
+  EXPECT_THROW(heap.free(small + 4), std::system_error);
+  EXPECT_THROW(heap.free(medium + 16), std::system_error);
+  EXPECT_THROW(heap.classOf(foreign), std::system_error);
+  EXPECT_EQ(heap.classOf(medium), 1u);
+
+  // the bad frees left the heap as it was
+  EXPECT_EQ(heap.freeSpace(0), 3u);
+  EXPECT_EQ(heap.freeSpace(1), 2u);
+  heap.free(small);
+  heap.free(medium);
+  EXPECT_EQ(heap.freeSpace(0), 4u);
+  EXPECT_EQ(heap.freeSpace(1), 3u);
+}
+
+
+TEST(SizeClassHeap, Fragmentation){
+  // fitting the classes to the message sizes wastes less than three coarse classes
+  using Coarse = memory::SizeClassHeap<memory::SizeClass<32, 1>, memory::SizeClass<128, 1>, memory::SizeClass<256, 1>>;
+  using Fitted = memory::SizeClassHeap<memory::SizeClass<12, 1>, memory::SizeClass<32, 1>, memory::SizeClass<48, 1>,
+      memory::SizeClass<96, 1>, memory::SizeClass<160, 1>, memory::SizeClass<256, 1>>;
+  uint32_t coarse = 0;
+  uint32_t fitted = 0;
+  for( uint32_t size : {8u, 10u, 13u, 29u, 40u, 47u, 90u, 150u} ) {
+    coarse += Coarse::wastedBytes(size);
+    fitted += Fitted::wastedBytes(size);
+  }
+  EXPECT_LT(fitted, coarse / 2);
+}
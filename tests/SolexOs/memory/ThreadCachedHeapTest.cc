@@ -0,0 +1,168 @@
+#include <SolexOs/memory/ThreadCachedHeap.hpp>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using TestHeap = memory::SizeClassHeap<memory::SizeClass<16, 256>, memory::SizeClass<64, 256>,
+    memory::SizeClass<256, 128>>;
+using CachedHeap = memory::ThreadCachedHeap<TestHeap, 8>;
+
+namespace {
+  constexpr uint32_t SIZES[] = {10, 40, 13, 200, 64, 8};
+  constexpr uint32_t COUNT = sizeof(SIZES) / sizeof(SIZES[0]);
+
+  /**
+   * Allocate, fill, check and free blocks of message sized payloads as an encode/decode would.
+   */
+  template<typename ALLOCATE, typename FREE>
+  bool churn(uint8_t tag, uint32_t rounds, ALLOCATE allocate, FREE free) {
+    bool intact = true;
+    uint8_t *blocks[COUNT];
+    for( uint32_t round = 0; round < rounds; round++ ) {
+      for( uint32_t i = 0; i < COUNT; i++ ) {
+        blocks[i] = allocate(SIZES[i]);
+        if( blocks[i] == nullptr ) {
+          return false;
+        }
+        std::fill(blocks[i], blocks[i] + SIZES[i], tag);
+      }
+      for( uint32_t i = 0; i < COUNT; i++ ) {
+        intact = intact && std::all_of(blocks[i], blocks[i] + SIZES[i], [tag](uint8_t byte) {return byte == tag;});
+        free(blocks[i]);
+      }
+    }
+    return intact;
+  }
+
+  void checkAllFree(CachedHeap &heap) {
+    EXPECT_EQ(heap.freeSpace(0), TestHeap::COUNTS[0]);
+    EXPECT_EQ(heap.freeSpace(1), TestHeap::COUNTS[1]);
+    EXPECT_EQ(heap.freeSpace(2), TestHeap::COUNTS[2]);
+  }
+}
+
+
+TEST(ThreadCachedHeap, BatchesTransfers){
+  static CachedHeap heap;
+  uint32_t before = heap.transfers();
+  EXPECT_TRUE(churn(1, 100, [](uint32_t size) {return heap.allocate(size);}, [](uint8_t *block) {heap.free(block);}));
+  // one refill per class, the blocks then cycle through the cache
+  EXPECT_EQ(heap.transfers() - before, 3u);
+  EXPECT_LT(heap.freeSpace(0), TestHeap::COUNTS[0]);
+  heap.flush();
+  checkAllFree(heap);
+}
+
+
+TEST(ThreadCachedHeap, ManyThreads){
+  static CachedHeap heap;
+  std::vector<std::thread> threads;
+  std::vector<int> intact(4, 0);
+  for( uint8_t t = 0; t < 4; t++ ) {
+    threads.emplace_back([t, &intact]() {
+      intact[t] = churn(static_cast<uint8_t>(t + 1), 2000, [](uint32_t size) {return heap.allocate(size);},
+          [](uint8_t *block) {heap.free(block);});
+    });
+  }
+  for( auto &thread : threads ) {
+    thread.join();
+  }
+  EXPECT_EQ(intact, std::vector<int>(4, 1));
+  // exiting threads return their caches
+  checkAllFree(heap);
+}
+
+
+TEST(ThreadCachedHeap, FreeOnOtherThread){
+  static CachedHeap heap;
+  std::vector<uint8_t *> blocks;
+  for( uint32_t i = 0; i < 40; i++ ) {
+    blocks.push_back(heap.allocate(16));
+  }
+  std::thread consumer([&blocks]() {
+    for( uint8_t *block : blocks ) {
+      heap.free(block);
+    }
+  });
+  consumer.join();
+  heap.flush();
+  checkAllFree(heap);
+}
+
+
+TEST(ThreadCachedHeap, ReportsErrors){
+  static CachedHeap heap;
+  EXPECT_THROW(heap.allocate(257), std::system_error);
+  std::vector<uint8_t *> blocks;
+  for( uint32_t i = 0; i < TestHeap::COUNTS[2]; i++ ) {
+    blocks.push_back(heap.allocate(256));
+  }
+  EXPECT_THROW(heap.allocate(256), std::system_error);
+
+  uint8_t foreign[16];
+  EXPECT_THROW(heap.free(foreign), std::system_error);
+  EXPECT_THROW(heap.free(blocks[0] + 1), std::system_error);
+  for( uint8_t *block : blocks ) {
+    heap.free(block);
+  }
+  heap.flush();
+  checkAllFree(heap);
+}
+
+
+TEST(ThreadCachedHeap, SuccessiveHeapsOnOneThread){
+  auto first = std::make_unique<CachedHeap>();
+  EXPECT_TRUE(churn(1, 10, [&first](uint32_t size) {return first->allocate(size);},
+      [&first](uint8_t *block) {first->free(block);}));
+  // destroyed with this thread's cache still full of its blocks
+  first.reset();
+
+  auto second = std::make_unique<CachedHeap>();
+  EXPECT_TRUE(churn(2, 10, [&second](uint32_t size) {return second->allocate(size);},
+      [&second](uint8_t *block) {second->free(block);}));
+  // the cache was refilled from the second heap rather than reusing the first heap's blocks
+  EXPECT_LT(second->freeSpace(0), TestHeap::COUNTS[0]);
+  second->flush();
+  checkAllFree(*second);
+}
+
+TEST(ThreadCachedHeap, DISABLED_Scaling){
+  constexpr uint32_t ROUNDS = 200000;
+  static CachedHeap cached;
+  static TestHeap shared;
+  static std::mutex sharedLock;
+  const uint32_t maxThreads = std::max(2u, std::thread::hardware_concurrency());
+
+  for( uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2 ) {
+    auto run = [threadCount](auto allocate, auto free) {
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for( uint32_t t = 0; t < threadCount; t++ ) {
+        threads.emplace_back([=]() {
+          churn(static_cast<uint8_t>(t), ROUNDS / threadCount, allocate, free);
+        });
+      }
+      for( auto &thread : threads ) {
+        thread.join();
+      }
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    double locked = run([](uint32_t size) {
+      std::lock_guard<std::mutex> guard(sharedLock);
+      return shared.allocate(size);
+    }, [](uint8_t *block) {
+      std::lock_guard<std::mutex> guard(sharedLock);
+      shared.free(block);
+    });
+    double perThread = run([](uint32_t size) {return cached.allocate(size);}, [](uint8_t *block) {cached.free(block);});
+    std::cout << threadCount << " threads: locked heap " << locked << " ms, thread cached " << perThread << " ms"
+              << std::endl;
+  }
+}
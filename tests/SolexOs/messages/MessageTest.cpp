@@ -5,7 +5,10 @@
 #include <tasks/position/MsgInterfacePosition.hpp>
 #include <utils/elements.hpp>
 #include <testFramework/memoryLeaks.hpp>
+#include <testFramework/NoAllocationScope.hpp>
 #include <gtest/gtest.h>
+#include <utility>
+#include <vector>
 
 namespace SolexOs {
 
@@ -197,4 +200,54 @@ namespace SolexOs {
 
   }
 
+  /**
+   * Decoding a payload into variables must not touch the heap.
+   */
+  TEST(MessageTest,testDecodeDoesNotAllocate){
+    uint8_t a;
+    uint16_t b;
+    uint32_t c;
+    int16_t d;
+    int32_t e;
+    uint8_t raw[] = {0x01, 0x02, 0x03, 0x04, 0x05,0x06,0x07,0xFE, 0xFF, 0xFD, 0xFF, 0xFF,0xFF};
+    ByteArray payload(raw, elements(raw));
+    auto msg = Message(MessageId::TEST_MESSAGE_2, elements(raw));
+    msg.getPayload() = payload;
+    {
+      NoAllocationScope noAllocation;
+      msg.decode(a,b,c,d,e);
+    }
+    EXPECT_EQ(e, -3);
+  }
+
+  /**
+   * Returning, moving and swapping messages must not duplicate their buffers.
+   */
+  TEST(MessageTest,testMoveDoesNotCopy){
+    auto before = allocationCounts();
+    {
+      auto data = createPayload();
+      Message msg = MSG_POSITION_MEASUREMENT::createMessage(0x12345678u,static_cast<uint8_t>(1u),PositionType::INVALID, 2u, 3u, data );
+      msg.setSourceAddress(SOURCE);
+    }
+    auto inPlace = allocationCounts() - before;
+
+    before = allocationCounts();
+    Message msg = createTestMessage();
+    EXPECT_LE((allocationCounts() - before).smallAllocations, inPlace.smallAllocations);
+
+    Message other = createTestMessage();
+    std::vector<Message> queue;
+    queue.reserve(2);
+    {
+      NoAllocationScope noAllocation;
+      Message temporary(std::move(msg));
+      std::swap(temporary, other);
+      queue.push_back(std::move(temporary));
+      queue.push_back(std::move(other));
+    }
+    EXPECT_EQ(queue[0], queue[1]);
+    EXPECT_EQ(queue[0], createTestMessage());
+  }
+
 }
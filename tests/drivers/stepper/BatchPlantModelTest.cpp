@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <testFramework/UnitAssert.hpp>
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <tests/drivers/stepper/BatchPlantModel.hpp>
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+constexpr double PERIOD = 0.000016;
+constexpr int32_t TICKS = 1024;
+
+/**
+ * The coil variations used by the sine tracking tests plus a spread around them.
+ */
+std::vector<Drivers::PlantParameters> createParameters() {
+  std::vector<Drivers::PlantParameters> parameters;
+  for( int32_t r = 0; r < 8; r++ ) {
+    for( int32_t l = 0; l < 8; l++ ) {
+      parameters.push_back({24.0, 14.0 + r, 0.020 + l * 0.002, 0.5});
+    }
+  }
+  parameters.push_back({24.0, 18.9, 0.0336, 24.0});
+  parameters.push_back({24.0, 15.5, 0.0224, 24.0});
+  return parameters;
+}
+
+TEST(BatchPlantModelTest, MatchesSinglePlants) {
+  auto parameters = createParameters();
+  Drivers::BatchStepperPlantModel batch(parameters, PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  std::vector<Drivers::StepperPlantModel<double>> plants;
+  for( const auto &p : parameters ) {
+    plants.emplace_back(p.V, p.R, p.L, p.k, PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  }
+  const uint32_t count = batch.size();
+  batch.reset(0.1);
+  std::vector<double> single(count, 0.1);
+  std::vector<double> speed(count);
+  std::vector<int32_t> duty(count);
+
+  for( int32_t step = 0; step < 50; step++ ) {
+    for( uint32_t i = 0; i < count; i++ ) {
+      speed[i] = 0.01 * ((step + i) % 7);
+      duty[i] = ((step * 37 + static_cast<int32_t>(i) * 101) % (2 * TICKS + 1)) - TICKS;
+    }
+    batch.advance(speed.data(), duty.data(), 10);
+    for( uint32_t i = 0; i < count; i++ ) {
+      for( int32_t j = 0; j < 10; j++ ) {
+        single[i] = plants[i].computeCurrentAtEndOfCycle(speed[i], single[i], batch.toDutyCycle(duty[i]));
+      }
+      checkTolerance(1e-9, batch.current(i), single[i]);
+    }
+  }
+}
+
+TEST(BatchPlantModelTest, ErrorTracking) {
+  std::vector<Drivers::PlantParameters> parameters = {{24.0, 17.8, 0.028, 0.0}, {24.0, 17.8, 0.028, 0.0}};
+  Drivers::BatchStepperPlantModel batch(parameters, PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  batch.reset(0.0);
+  const double target[] = {0.0, 0.5};
+  batch.recordError(target);
+  batch.recordError(target);
+  checkTolerance(1e-12, batch.rmsError(0), 0.0);
+  checkTolerance(1e-12, batch.rmsError(1), 0.5);
+  checkTolerance(1e-12, batch.maxError(1), 0.5);
+  batch.resetErrors();
+  checkTolerance(1e-12, batch.maxError(1), 0.0);
+}
+
+TEST(BatchPlantModelTest, DutyOutOfRange) {
+  std::vector<Drivers::PlantParameters> parameters = {{24.0, 17.8, 0.028, 0.0}, {24.0, 17.8, 0.028, 0.0}};
+  Drivers::BatchStepperPlantModel batch(parameters, PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  const double speed[] = {0.0, 0.0};
+  const int32_t full[] = {TICKS, -TICKS};
+  const int32_t over[] = {0, TICKS + 1};
+  const int32_t under[] = {-TICKS - 1, 0};
+  EXPECT_NO_THROW(batch.advance(speed, full));
+  EXPECT_THROW(batch.advance(speed, over), std::out_of_range);
+  EXPECT_THROW(batch.advance(speed, under), std::out_of_range);
+}
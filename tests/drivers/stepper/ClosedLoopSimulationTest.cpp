@@ -0,0 +1,232 @@
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <waveforms/SineGenerator.hpp>
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <tests/drivers/stepper/ClosedLoopSimulation.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using Drivers::DutyCycle;
+using Drivers::PidTuning;
+using FP = numeric::FixedPoint<22>;
+using FP16 = numeric::FixedPoint<16, int32_t>;
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+constexpr double STEP = 0.000160;
+
+const PidTuning<double> TUNING = {-0.35, 0.9, 0.1, 0.1, -0.1, 0.025, 0.0, 0.0};
+
+/**
+ * Parts of the sine tracking loop from PidControllerTest.
+ */
+struct SineLoop {
+    Drivers::RuntimePidController<double> pid;
+    Drivers::StepperPredictiveModel<double> pwm;
+    Drivers::StepperPlantModel<double> plant;
+    Drivers::SineGenerator<FP> sine;
+    Drivers::SineSetpoint<Drivers::SineGenerator<FP>, double> setpoint;
+
+    SineLoop() :
+            pid(TUNING),
+            pwm(24, 17.8, 0.028, 0.0, STEP, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024),
+            plant(24, 18.9, 0.0336, 24, 0.000016, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+                Drivers::PlantEvaluation::CACHED),
+            sine(STEP * 100),
+            setpoint(sine, STEP, 100) {
+    }
+};
+
+/**
+ * Samples kept in memory for checking.
+ */
+struct VectorTrace {
+    std::vector<Drivers::SimulationSample> samples;
+
+    void record(const Drivers::SimulationSample &sample) {
+      samples.push_back(sample);
+    }
+};
+
+/**
+ * The loop of testSineTracking in PidControllerTest, with the sine taken straight from the generator.
+ */
+TEST(ClosedLoopSimulationTest, MatchesHandWrittenLoop) {
+  SineLoop reference;
+  double currentI = 0.0;
+  double error = 0.0;
+  double In[200];
+  for( int i = 1; i < 200; i++ ) {
+    if( i == 100 ) {
+      error = 0.0;
+    }
+    auto t = (i % 100) * STEP;
+    auto tlast = t - STEP;
+    auto target = reference.sine.calculateSine(t).asDouble();
+    auto prevTarget = reference.sine.calculateSine(tlast).asDouble();
+    auto errorDelta = prevTarget - currentI;
+    error = error + errorDelta * errorDelta;
+    auto deltaI = reference.pid.computeOutput(currentI, prevTarget);
+    DutyCycle duty = reference.pwm.computeDutyCycle(0.0, deltaI + target, currentI);
+    for( int j = 0; j < 10; j++ ) {
+      currentI = reference.plant.computeCurrentAtEndOfCycle(0.0, currentI, duty);
+    }
+    In[i] = currentI;
+  }
+
+  SineLoop loop;
+  VectorTrace trace;
+  auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL);
+  simulation.run(99, loop.setpoint, Drivers::ConstantSpeed{0.0}, trace);
+  simulation.resetErrors();
+  simulation.run(100, loop.setpoint, Drivers::ConstantSpeed{0.0}, trace);
+
+  ASSERT_EQ(trace.samples.size(), 199u);
+  for( int i = 1; i < 200; i++ ) {
+    EXPECT_EQ(trace.samples[i - 1].tick, static_cast<uint64_t>(i));
+    EXPECT_EQ(trace.samples[i - 1].current, In[i]);
+  }
+  EXPECT_EQ(simulation.tick(), 199u);
+  checkTolerance(1e-12, simulation.rmsError(), sqrt(error / 100));
+}
+
+/**
+ * The loop of testSineTracking in PidControllerTestFixedPoint: scaled units, the sine in whole ticks, the
+ * current held in FixedPoint<16> between plant cycles and the squared error summed in FixedPoint<16> over
+ * the second period.
+ */
+TEST(ClosedLoopSimulationTest, MatchesFixedPointLoop) {
+  const PidTuning<FP16> tuning = {FP16(-0.35), FP16(0.9), FP16(0.1), FP16(0.1), FP16(-0.1), FP16(0.025), FP16(0.0),
+    FP16(0.0)};
+  Drivers::SineGenerator<FP16> sine(100);
+  Drivers::StepperPlantModel<double> plant(24.0, 18.9, 34, 0.0, 0.016, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024);
+
+  Drivers::RuntimePidController<FP16> referencePid(tuning);
+  Drivers::StepperPredictiveModel<FP16> referencePwm(24, 17.8, 28, 0.0, 0.16, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024);
+  FP16 In[200];
+  In[0] = 0.0;
+  FP16 error = 0.0;
+  for( int i = 1; i < 200; i++ ) {
+    if( i == 100 ) {
+      error = 0.0;
+    }
+    FP16 currentI = In[i - 1];
+    auto target = sine.calculateSine(i);
+    auto prevTarget = sine.calculateSine(i - 1);
+    auto errorDelta = prevTarget - currentI;
+    error = error + errorDelta * errorDelta;
+    auto deltaI = referencePid.computeOutput(currentI, prevTarget);
+    DutyCycle duty = referencePwm.computeDutyCycle(FP16(0.0), deltaI + target, currentI);
+    for( int j = 0; j < 10; j++ ) {
+      currentI = plant.computeCurrentAtEndOfCycle(0.0, currentI.asDouble(), duty);
+    }
+    In[i] = currentI;
+  }
+
+  Drivers::RuntimePidController<FP16> pid(tuning);
+  Drivers::StepperPredictiveModel<FP16> pwm(24, 17.8, 28, 0.0, 0.16, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024);
+  VectorTrace trace;
+  auto setpoint = [&sine](uint64_t tick) {
+    return sine.calculateSine(static_cast<int>(tick)).asDouble();
+  };
+  auto simulation = Drivers::makeSimulation<FP16, FP16>(pid, pwm, plant, NEGATIVE_CHANNEL);
+  simulation.run(99, setpoint, Drivers::ConstantSpeed{0.0}, trace);
+  simulation.resetErrors();
+  simulation.run(100, setpoint, Drivers::ConstantSpeed{0.0}, trace);
+  for( int i = 1; i < 200; i++ ) {
+    EXPECT_EQ(trace.samples[i - 1].current, In[i].asDouble());
+  }
+  EXPECT_EQ(simulation.rmsError(), sqrt(error.asDouble() / 100));
+}
+
+TEST(ClosedLoopSimulationTest, Decimation) {
+  SineLoop loop;
+  VectorTrace trace;
+  auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL, {10, 25});
+  simulation.run(1000, loop.setpoint, Drivers::ConstantSpeed{0.0}, trace);
+  ASSERT_EQ(trace.samples.size(), 40u);
+  EXPECT_EQ(trace.samples[0].tick, 25u);
+  EXPECT_EQ(trace.samples[39].tick, 1000u);
+}
+
+TEST(ClosedLoopSimulationTest, DecimationZeroRejected) {
+  SineLoop loop;
+  EXPECT_THROW(Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL, {10, 0}),
+      std::system_error);
+}
+
+TEST(ClosedLoopSimulationTest, CsvTrace) {
+  SineLoop loop;
+  std::ostringstream out;
+  Drivers::CsvTrace trace(out);
+  auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL, {10, 50});
+  simulation.run(100, loop.setpoint, Drivers::SpeedRamp{0.0, 2.0, 100}, trace);
+
+  std::istringstream in(out.str());
+  std::string line;
+  std::getline(in, line);
+  EXPECT_EQ(line, "tick,target,current,correction,speed,duty");
+  std::getline(in, line);
+  EXPECT_EQ(line.substr(0, 3), "50,");
+  std::getline(in, line);
+  EXPECT_EQ(line.substr(0, 4), "100,");
+  EXPECT_EQ(std::getline(in, line).eof(), true);
+}
+
+TEST(ClosedLoopSimulationTest, BinaryTrace) {
+  SineLoop loop;
+  std::ostringstream out;
+  {
+    Drivers::BinaryTrace trace(out);
+    auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL);
+    simulation.run(5000, loop.setpoint, Drivers::ConstantSpeed{0.0}, trace);
+  }
+  SineLoop reference;
+  VectorTrace expected;
+  auto simulation = Drivers::makeSimulation<double>(reference.pid, reference.pwm, reference.plant, NEGATIVE_CHANNEL);
+  simulation.run(5000, reference.setpoint, Drivers::ConstantSpeed{0.0}, expected);
+
+  std::string data = out.str();
+  ASSERT_EQ(Drivers::BinaryTrace::RECORD_SIZE, 44u);
+  ASSERT_EQ(data.size(), 5000 * Drivers::BinaryTrace::RECORD_SIZE);
+  for( size_t i : {size_t(0), size_t(4095), size_t(4096), size_t(4999)} ) {
+    auto sample = Drivers::BinaryTrace::decode(data.data() + i * Drivers::BinaryTrace::RECORD_SIZE);
+    EXPECT_EQ(sample.tick, i + 1);
+    EXPECT_EQ(sample.target, expected.samples[i].target);
+    EXPECT_EQ(sample.current, expected.samples[i].current);
+    EXPECT_EQ(sample.correction, expected.samples[i].correction);
+    EXPECT_EQ(sample.speed, expected.samples[i].speed);
+    EXPECT_EQ(sample.duty, expected.samples[i].duty);
+  }
+}
+
+TEST(ClosedLoopSimulationTest, Profiles) {
+  SineLoop loop;
+  VectorTrace trace;
+  auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL);
+  simulation.run(200, Drivers::StepSetpoint{0.0, 0.4, 10}, Drivers::SpeedRamp{0.0, 4.0, 100}, trace);
+  EXPECT_EQ(trace.samples[8].target, 0.0);
+  EXPECT_EQ(trace.samples[9].target, 0.4);
+  EXPECT_EQ(trace.samples[49].speed, 2.0);
+  EXPECT_EQ(trace.samples[149].speed, 4.0);
+}
+
+/**
+ * A million ticks of sine tracking with no trace, run with --gtest_also_run_disabled_tests.
+ */
+TEST(ClosedLoopSimulationTest, DISABLED_LongRun) {
+  constexpr uint64_t TICKS = 1000000;
+  SineLoop loop;
+  auto simulation = Drivers::makeSimulation<double>(loop.pid, loop.pwm, loop.plant, NEGATIVE_CHANNEL);
+  auto start = std::chrono::steady_clock::now();
+  simulation.run(TICKS, loop.setpoint, Drivers::ConstantSpeed{0.0});
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << TICKS << " ticks " << elapsed.count() / TICKS << " ns/tick rms=" << simulation.rmsError() << std::endl;
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <system_error>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <drivers/stepper/DutyCycleTable.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using FP = numeric::FixedPoint<16>;
+
+constexpr FP COIL_INDUCTANCE = FP(28.0);
+constexpr FP COIL_RESISTANCE = FP(17.2);
+constexpr FP BACK_EMF = FP(4.0);
+constexpr FP DECIMATION_INTERVAL = FP(0.016);
+constexpr FP VOLTS = FP(24.0);
+
+constexpr int32_t TICKS = 1024;
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+
+int32_t signedDuty(Drivers::DutyCycle duty) {
+  return (duty.channel == NEGATIVE_CHANNEL) ? -static_cast<int32_t>(duty.duty) : duty.duty;
+}
+
+/**
+ * The ranges a table is built over, shared by the construction and the sweep.
+ */
+struct TableRange {
+    double minCurrent;
+    double maxCurrent;
+    double minTarget;
+    double maxTarget;
+    double minSpeed;
+    double maxSpeed;
+};
+
+constexpr TableRange RANGE = {0.499, 0.501, 0.483, 0.507, 0.0, 0.5};
+
+/**
+ * Grid point i of an axis, worked out the same way as the table so the corners match its samples.
+ */
+FP gridPoint(double min, double max, uint32_t steps, uint32_t i) {
+  if( steps == 1 ) {
+    return FP(min);
+  }
+  return FP(min) + (FP(max) - FP(min)) * static_cast<int32_t>(i) / static_cast<int32_t>(steps - 1);
+}
+
+/**
+ * Cell of an axis holding sample i of samples spread over it.
+ */
+uint32_t cellOf(uint32_t i, uint32_t samples, uint32_t steps) {
+  if( steps == 1 ) {
+    return 0;
+  }
+  uint32_t cell = i * (steps - 1) / (samples - 1);
+  return (cell > steps - 2) ? steps - 2 : cell;
+}
+
+/**
+ * How far a table is from the model, in PWM counts.
+ */
+struct ModelError {
+    double rms;
+    int32_t maxError;
+    int32_t points;
+    int32_t maxKinkError;
+    int32_t kinks;
+};
+
+/**
+ * Compare the table against the analytic model over its whole range, on a grid that does not line up with
+ * the table points, and report the error in PWM counts.
+ *
+ * Where every corner of the cell is inside the linear part of the model the interpolation must be within
+ * tolerance. Where the model saturates or changes channel inside the cell the surface has a kink that the
+ * interpolation can only follow to within the cell, so there the result must lie between the smallest and
+ * largest model duty at the corners of the cell (a rounding count either way).
+ */
+template<uint32_t CURRENT_STEPS, uint32_t TARGET_STEPS, uint32_t SPEED_STEPS, typename TABLE>
+ModelError checkAgainstModel(Drivers::StepperPredictiveModel<FP> &model, const TABLE &table, const TableRange &range,
+    int32_t tolerance) {
+  constexpr uint32_t CURRENT_SAMPLES = 4 * (CURRENT_STEPS - 1) + 1;
+  constexpr uint32_t TARGET_SAMPLES = 3 * (TARGET_STEPS - 1) + 1;
+  constexpr uint32_t SPEED_SAMPLES = (SPEED_STEPS == 1) ? 1 : 2 * (SPEED_STEPS - 1) + 1;
+  constexpr int32_t ROUNDING = 1;
+  int32_t maxError = 0;
+  int32_t maxKinkError = 0;
+  double total = 0;
+  int32_t count = 0;
+  int32_t kinks = 0;
+  for( uint32_t s = 0; s < SPEED_SAMPLES; s++ ) {
+    // samples sit a third of a sample step off the grid so they fall inside cells
+    double speedFraction = (SPEED_SAMPLES == 1) ? 0.0 : (s + ((s + 1 < SPEED_SAMPLES) ? 0.3 : 0.0)) / (SPEED_SAMPLES - 1);
+    FP speed = FP(range.minSpeed + (range.maxSpeed - range.minSpeed) * speedFraction);
+    uint32_t sc = cellOf(s, SPEED_SAMPLES, SPEED_STEPS);
+    for( uint32_t c = 0; c < CURRENT_SAMPLES; c++ ) {
+      double currentFraction = (c + ((c + 1 < CURRENT_SAMPLES) ? 0.3 : 0.0)) / (CURRENT_SAMPLES - 1);
+      FP current = FP(range.minCurrent + (range.maxCurrent - range.minCurrent) * currentFraction);
+      uint32_t cc = cellOf(c, CURRENT_SAMPLES, CURRENT_STEPS);
+      for( uint32_t t = 0; t < TARGET_SAMPLES; t++ ) {
+        double targetFraction = (t + ((t + 1 < TARGET_SAMPLES) ? 0.3 : 0.0)) / (TARGET_SAMPLES - 1);
+        FP target = FP(range.minTarget + (range.maxTarget - range.minTarget) * targetFraction);
+        uint32_t tc = cellOf(t, TARGET_SAMPLES, TARGET_STEPS);
+
+        int32_t low = TICKS;
+        int32_t high = -TICKS;
+        bool kink = false;
+        for( uint32_t corner = 0; corner < 8; corner++ ) {
+          uint32_t ds = (SPEED_STEPS == 1) ? 0 : (corner >> 2) & 1;
+          int32_t duty = signedDuty(model.computeDutyCycle(
+              gridPoint(range.minSpeed, range.maxSpeed, SPEED_STEPS, sc + ds),
+              gridPoint(range.minTarget, range.maxTarget, TARGET_STEPS, tc + (corner & 1)),
+              gridPoint(range.minCurrent, range.maxCurrent, CURRENT_STEPS, cc + ((corner >> 1) & 1))));
+          low = std::min(low, duty);
+          high = std::max(high, duty);
+          kink = kink || (abs(duty) == 0) || (abs(duty) == TICKS);
+        }
+        kink = kink || (low < 0 && high > 0);
+
+        int32_t expected = signedDuty(model.computeDutyCycle(speed, target, current));
+        int32_t actual = signedDuty(table.computeDutyCycle(speed, target, current));
+        int32_t error = abs(expected - actual);
+        EXPECT_GE(actual, low - ROUNDING) << "speed " << speed.asDouble() << " current " << current.asDouble()
+            << " target " << target.asDouble();
+        EXPECT_LE(actual, high + ROUNDING) << "speed " << speed.asDouble() << " current " << current.asDouble()
+            << " target " << target.asDouble();
+        if( kink ) {
+          maxKinkError = std::max(maxKinkError, error);
+          kinks++;
+          continue;
+        }
+        EXPECT_LE(error, tolerance) << "speed " << speed.asDouble() << " current " << current.asDouble()
+            << " target " << target.asDouble();
+        maxError = std::max(maxError, error);
+        total = total + error * error;
+        count++;
+      }
+    }
+  }
+  EXPECT_GT(count, 0);
+  EXPECT_GT(kinks, 0);
+  return {sqrt(total / count), maxError, count, maxKinkError, kinks};
+}
+
+std::ostream &operator<<(std::ostream &out, const ModelError &error) {
+  return out << "rms error=" << error.rms << " max error=" << error.maxError << " counts over " << error.points
+             << " points, max error " << error.maxKinkError << " counts over " << error.kinks << " points at kinks";
+}
+
+/**
+ * Outside its range the table holds the value at the nearest edge.
+ */
+template<typename TABLE>
+void checkClamped(const TABLE &table, const TableRange &range, FP speed) {
+  constexpr double MARGIN = 0.01;
+  for( double current : {range.minCurrent, 0.5 * (range.minCurrent + range.maxCurrent), range.maxCurrent} ) {
+    for( double target : {range.minTarget, 0.5 * (range.minTarget + range.maxTarget), range.maxTarget} ) {
+      int32_t edge = signedDuty(table.computeDutyCycle(speed, FP(target), FP(current)));
+      double outsideCurrent = (current == range.minCurrent) ? current - MARGIN :
+                              (current == range.maxCurrent) ? current + MARGIN : current;
+      double outsideTarget = (target == range.minTarget) ? target - MARGIN :
+                             (target == range.maxTarget) ? target + MARGIN : target;
+      EXPECT_EQ(signedDuty(table.computeDutyCycle(speed, FP(outsideTarget), FP(outsideCurrent))), edge);
+    }
+  }
+}
+
+TEST(DutyCycleTable, Bilinear){
+  Drivers::StepperPredictiveModel<FP> model(VOLTS, COIL_RESISTANCE, COIL_INDUCTANCE, BACK_EMF, DECIMATION_INTERVAL,
+      POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  TableRange range = RANGE;
+  range.maxSpeed = range.minSpeed;
+  Drivers::DutyCycleTable<FP, 9, 33> table(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(range.minCurrent),
+      FP(range.maxCurrent), FP(range.minTarget), FP(range.maxTarget));
+  checkAgainstModel<9, 33, 1>(model, table, range, 3);
+  checkClamped(table, range, FP(0.0));
+}
+
+TEST(DutyCycleTable, Trilinear){
+  Drivers::StepperPredictiveModel<FP> model(VOLTS, COIL_RESISTANCE, COIL_INDUCTANCE, BACK_EMF, DECIMATION_INTERVAL,
+      POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  Drivers::DutyCycleTable<FP, 9, 33, 5> table(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(RANGE.minCurrent),
+      FP(RANGE.maxCurrent), FP(RANGE.minTarget), FP(RANGE.maxTarget), FP(RANGE.minSpeed), FP(RANGE.maxSpeed));
+  checkAgainstModel<9, 33, 5>(model, table, RANGE, 3);
+  checkClamped(table, RANGE, FP(0.25));
+}
+
+TEST(DutyCycleTable, EmptyRangeRejected){
+  Drivers::StepperPredictiveModel<FP> model(VOLTS, COIL_RESISTANCE, COIL_INDUCTANCE, BACK_EMF, DECIMATION_INTERVAL,
+      POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  using Table = Drivers::DutyCycleTable<FP, 9, 33>;
+  EXPECT_THROW(Table(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(0.5), FP(0.5), FP(RANGE.minTarget),
+      FP(RANGE.maxTarget)), std::system_error);
+  EXPECT_THROW(Table(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(RANGE.minCurrent), FP(RANGE.maxCurrent),
+      FP(0.5), FP(0.5)), std::system_error);
+}
+
+/**
+ * Error of both tables against the model. Run with --gtest_also_run_disabled_tests.
+ */
+TEST(DutyCycleTable, DISABLED_ErrorReport){
+  Drivers::StepperPredictiveModel<FP> model(VOLTS, COIL_RESISTANCE, COIL_INDUCTANCE, BACK_EMF, DECIMATION_INTERVAL,
+      POSITIVE_CHANNEL, NEGATIVE_CHANNEL, TICKS);
+  TableRange range = RANGE;
+  range.maxSpeed = range.minSpeed;
+  Drivers::DutyCycleTable<FP, 9, 33> bilinear(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(range.minCurrent),
+      FP(range.maxCurrent), FP(range.minTarget), FP(range.maxTarget));
+  Drivers::DutyCycleTable<FP, 9, 33, 5> trilinear(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(RANGE.minCurrent),
+      FP(RANGE.maxCurrent), FP(RANGE.minTarget), FP(RANGE.maxTarget), FP(RANGE.minSpeed), FP(RANGE.maxSpeed));
+  std::cout << "bilinear " << checkAgainstModel<9, 33, 1>(model, bilinear, range, 3) << std::endl;
+  std::cout << "trilinear " << checkAgainstModel<9, 33, 5>(model, trilinear, RANGE, 3) << std::endl;
+}
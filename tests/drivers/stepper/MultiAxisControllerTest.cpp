@@ -0,0 +1,193 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/DutyCycleTable.hpp>
+#include <drivers/stepper/MultiAxisController.hpp>
+#include <drivers/stepper/PidController.hpp>
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <testFramework/NoAllocationScope.hpp>
+
+using Drivers::DutyCycle;
+using Drivers::PidTuning;
+using FP16 = numeric::FixedPoint<16, int32_t>;
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+constexpr uint32_t AXES = 4;
+
+template<typename T>
+PidTuning<T> testTuning() {
+  return {T(-0.35), T(0.9), T(0.1), T(0.1), T(-0.1), T(0.025), T(0.0), T(0.0)};
+}
+
+/**
+ * testTuning as compile time parameters for PidController.
+ */
+struct TickParameters {
+    static constexpr FP16 Kd = FP16(0.1);
+    static constexpr FP16 Kp = FP16(-0.35);
+    static constexpr FP16 Ki = FP16(0.9);
+    static constexpr FP16 MAX_OUTPUT_VALUE = FP16(0.1);
+    static constexpr FP16 MIN_OUTPUT_VALUE = FP16(-0.1);
+    static constexpr FP16 MAX_INTEGRAL = FP16(0.025);
+    static constexpr FP16 RESET_VALUE_ERROR = FP16(0.0);
+    static constexpr FP16 RESET_VALUE_INTEGRAL = FP16(0.0);
+    static constexpr FP16 RESET_VALUE_SETPOINT = FP16(0.0);
+};
+
+template<typename T>
+Drivers::StepperPredictiveModel<T> testModel() {
+  return Drivers::StepperPredictiveModel<T>(T(24.0), T(17.8), T(0.028), T(0.0), T(0.000160), POSITIVE_CHANNEL,
+      NEGATIVE_CHANNEL, 1024);
+}
+
+/**
+ * Run the batched controller and one RuntimePidController per axis side by side against a plant per axis
+ * and check they give the same duty cycles.
+ */
+template<typename T>
+void checkMatchesSingleAxis() {
+  auto model = testModel<T>();
+  Drivers::MultiAxisController<T, AXES> batch(model, testTuning<T>());
+  std::vector<Drivers::RuntimePidController<T>> single(AXES, Drivers::RuntimePidController<T>(testTuning<T>()));
+  std::vector<Drivers::StepperPlantModel<double>> plants;
+  for( uint32_t axis = 0; axis < AXES; axis++ ) {
+    plants.emplace_back(24, 18.9 - axis, 0.0336, 24, 0.000016, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+        Drivers::PlantEvaluation::CACHED);
+  }
+
+  T speed[AXES];
+  T target[AXES];
+  T current[AXES];
+  double plantCurrent[AXES] = {};
+  std::vector<DutyCycle> duty(AXES, DutyCycle(0, POSITIVE_CHANNEL));
+  for( int tick = 0; tick < 100; tick++ ) {
+    for( uint32_t axis = 0; axis < AXES; axis++ ) {
+      speed[axis] = T(0.0);
+      target[axis] = T(0.5 * sin((tick + 25 * axis) * 0.0628));
+      current[axis] = T(plantCurrent[axis]);
+    }
+    batch.update(speed, target, current, duty.data());
+    for( uint32_t axis = 0; axis < AXES; axis++ ) {
+      T deltaI = single[axis].computeOutput(current[axis], target[axis]);
+      DutyCycle expected = model.computeDutyCycle(speed[axis], target[axis] + deltaI, current[axis]);
+      EXPECT_EQ(duty[axis].duty, expected.duty);
+      EXPECT_EQ(duty[axis].channel == expected.channel, true);
+      for( int j = 0; j < 10; j++ ) {
+        plantCurrent[axis] = plants[axis].computeCurrentAtEndOfCycle(0.0, plantCurrent[axis], duty[axis]);
+      }
+    }
+  }
+}
+
+TEST(MultiAxisControllerTest, MatchesSingleAxisDouble) {
+  checkMatchesSingleAxis<double>();
+}
+
+TEST(MultiAxisControllerTest, MatchesSingleAxisFixedPoint) {
+  checkMatchesSingleAxis<FP16>();
+}
+
+TEST(MultiAxisControllerTest, ResetAxis) {
+  auto model = testModel<double>();
+  Drivers::MultiAxisController<double, 2> batch(model, testTuning<double>());
+  double speed[2] = {0.0, 0.0};
+  double target[2] = {0.5, 0.5};
+  double current[2] = {0.45, 0.45};
+  std::vector<DutyCycle> duty(2, DutyCycle(0, POSITIVE_CHANNEL));
+  batch.update(speed, target, current, duty.data());
+  batch.update(speed, target, current, duty.data());
+  batch.reset(1);
+  EXPECT_EQ(batch.correction(1), 0.0);
+  batch.update(speed, target, current, duty.data());
+  EXPECT_NE(batch.correction(0), batch.correction(1));
+}
+
+TEST(MultiAxisControllerTest, DutyCycleTableModel) {
+  using FP = numeric::FixedPoint<16>;
+  Drivers::StepperPredictiveModel<FP> model(FP(24.0), FP(17.2), FP(28.0), FP(4.0), FP(0.016), POSITIVE_CHANNEL,
+      NEGATIVE_CHANNEL, 1024);
+  Drivers::DutyCycleTable<FP, 17, 17> table(model, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, FP(-1.0), FP(1.0), FP(-1.0),
+      FP(1.0));
+  Drivers::MultiAxisController<FP, 2, const Drivers::DutyCycleTable<FP, 17, 17>> batch(table, testTuning<FP>());
+  Drivers::RuntimePidController<FP> single(testTuning<FP>());
+  FP speed[2] = {FP(0.0), FP(0.0)};
+  FP target[2] = {FP(0.3), FP(-0.3)};
+  FP current[2] = {FP(0.25), FP(-0.25)};
+  std::vector<DutyCycle> duty(2, DutyCycle(0, POSITIVE_CHANNEL));
+  batch.update(speed, target, current, duty.data());
+  DutyCycle expected = table.computeDutyCycle(speed[0], target[0] + single.computeOutput(current[0], target[0]),
+      current[0]);
+  EXPECT_EQ(duty[0].duty, expected.duty);
+  EXPECT_EQ(duty[0].channel == expected.channel, true);
+  EXPECT_EQ(duty[1].channel == NEGATIVE_CHANNEL, true);
+}
+
+TEST(MultiAxisControllerTest, TickDoesNotAllocate) {
+  auto model = testModel<FP16>();
+  Drivers::MultiAxisController<FP16, AXES> batch(model, testTuning<FP16>());
+  Drivers::RuntimePidController<FP16> pid(testTuning<FP16>());
+  Drivers::PidController<FP16, TickParameters> fixedPid;
+  FP16 speed[AXES] = {};
+  FP16 target[AXES] = {FP16(0.1), FP16(0.2), FP16(-0.1), FP16(0.0)};
+  FP16 current[AXES] = {};
+  DutyCycle duty[AXES] = {DutyCycle(0, POSITIVE_CHANNEL), DutyCycle(0, POSITIVE_CHANNEL),
+    DutyCycle(0, POSITIVE_CHANNEL), DutyCycle(0, POSITIVE_CHANNEL)};
+
+  NoAllocationScope noAllocation;
+  for( int tick = 0; tick < 10; tick++ ) {
+    FP16 deltaI = pid.computeOutput(current[0], target[0]);
+    duty[0] = model.computeDutyCycle(speed[0], target[0] + deltaI, current[0]);
+    deltaI = fixedPid.computeOutput(current[1], target[1]);
+    duty[1] = model.computeDutyCycle(speed[1], target[1] + deltaI, current[1]);
+    batch.update(speed, target, current, duty);
+  }
+}
+
+/**
+ * Time per tick for 8 axes updated one at a time against the batched update. Run with
+ * --gtest_also_run_disabled_tests on an optimised build.
+ */
+TEST(MultiAxisControllerTest, DISABLED_TickCost) {
+  constexpr uint32_t MACHINE_AXES = 8;
+  constexpr int TICKS = 20000;
+  auto model = testModel<FP16>();
+  Drivers::MultiAxisController<FP16, MACHINE_AXES> batch(model, testTuning<FP16>());
+  std::vector<Drivers::RuntimePidController<FP16>> single(MACHINE_AXES,
+      Drivers::RuntimePidController<FP16>(testTuning<FP16>()));
+
+  FP16 speed[MACHINE_AXES];
+  FP16 target[MACHINE_AXES];
+  FP16 current[MACHINE_AXES];
+  for( uint32_t axis = 0; axis < MACHINE_AXES; axis++ ) {
+    speed[axis] = FP16(0.0);
+    target[axis] = FP16(0.1 * axis);
+    current[axis] = FP16(0.1 * axis - 0.05);
+  }
+  std::vector<DutyCycle> duty(MACHINE_AXES, DutyCycle(0, POSITIVE_CHANNEL));
+  uint32_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for( int tick = 0; tick < TICKS; tick++ ) {
+    for( uint32_t axis = 0; axis < MACHINE_AXES; axis++ ) {
+      FP16 deltaI = single[axis].computeOutput(current[axis], target[axis]);
+      duty[axis] = model.computeDutyCycle(speed[axis], target[axis] + deltaI, current[axis]);
+      sink += duty[axis].duty;
+    }
+  }
+  std::chrono::duration<double, std::nano> separate = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for( int tick = 0; tick < TICKS; tick++ ) {
+    batch.update(speed, target, current, duty.data());
+    sink += duty[0].duty;
+  }
+  std::chrono::duration<double, std::nano> batched = std::chrono::steady_clock::now() - start;
+
+  std::cout << MACHINE_AXES << " axes: separate " << separate.count() / TICKS << " ns/tick, batched "
+            << batched.count() / TICKS << " ns/tick (" << sink << ")" << std::endl;
+}
@@ -6,6 +6,7 @@
 #include <drivers/stepper/StepperPredictiveModel.hpp>
 #include <waveforms/SineGenerator.hpp>
 #include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <tests/drivers/stepper/ClosedLoopSimulation.hpp>
 #include <testFramework/UnitAssert.hpp>
 
 using Drivers::PWM_CHANNEL;
@@ -54,30 +55,13 @@ void testSineTracking(Drivers::PidController<T, S> pidController, Drivers::Stepp
   Drivers::SineGenerator<FP> sine(PERIOD);
   Drivers::StepperPredictiveModel<T> pwm(24, 17.8, 0.028, 0.0, stepSize, POSITIVE_CHANNEL, NEGATIVE_CHANNEL,
       1024);
+  Drivers::SineSetpoint<Drivers::SineGenerator<FP>, double> setpoint(sine, stepSize, 100);
 
-  T In[200];
-  In[0] = 0.0;
-  T error = 0.0;
-  for (int i = 1; i < 200; i++) {
-    if (i == 100) {
-      error = 0.0;
-    }
-
-    T currentI = In[i - 1];
-    auto t = (i % 100) * stepSize;
-    auto tlast = t - stepSize;
-    auto target = sine.calculateSine(t).asDouble();
-    auto prevTarget = sine.calculateSine(tlast).asDouble();
-    auto errorDelta = prevTarget - currentI;
-    error = error + errorDelta * errorDelta;
-    auto deltaI = pidController.computeOutput(currentI, prevTarget);
-    DutyCycle duty = pwm.computeDutyCycle(SPEED, deltaI + target, currentI);
-    for (int j = 0; j < 10; j++) {
-      currentI = plant.computeCurrentAtEndOfCycle(SPEED, currentI, duty);
-    }
-    In[i] = currentI;
-  }
-  checkTolerance(0.001, sqrt(error / 100), 0.001);
+  auto simulation = Drivers::makeSimulation<T>(pidController, pwm, plant, NEGATIVE_CHANNEL);
+  simulation.run(99, setpoint, Drivers::ConstantSpeed{SPEED});
+  simulation.resetErrors();
+  simulation.run(100, setpoint, Drivers::ConstantSpeed{SPEED});
+  checkTolerance(0.001, simulation.rmsError(), 0.001);
 }
 
 TEST(PidControllerTest, SmallStep) {
@@ -177,6 +161,23 @@ TEST(PidControllerTest, SineLow) {
   testSineTracking(pidControler, plant, 0.000160);
 }
 
+/**
+ * The same tracking against the plant evaluated from cached decay factors.
+ */
+TEST(PidControllerTest, SineHighCached) {
+  Drivers::PidController<double, TestParameters> pidControler;
+  Drivers::StepperPlantModel<double> plant(24, 18.9, 0.0336, 24, 0.000016,POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  testSineTracking(pidControler, plant, 0.000160);
+}
+
+TEST(PidControllerTest, SineLowCached) {
+  Drivers::PidController<double, TestParameters> pidControler;
+  Drivers::StepperPlantModel<double> plant(24, 15.5, 0.0224, 24, 0.000016,POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  testSineTracking(pidControler, plant, 0.000160);
+}
+
 
 constexpr double TestParameters::Kd;
 constexpr double TestParameters::Kp;
@@ -6,6 +6,7 @@
 #include <drivers/stepper/StepperPredictiveModel.hpp>
 #include <waveforms/SineGenerator.hpp>
 #include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <tests/drivers/stepper/ClosedLoopSimulation.hpp>
 #include <testFramework/UnitAssert.hpp>
 
 template<typename T>
@@ -95,35 +96,22 @@ constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
 
 template<typename T, typename S>
 void testSineTracking(Drivers::PidController<T, S> pidController, Drivers::StepperPlantModel<double> plant) {
-  constexpr FP SPEED = FP(0.0);
-  constexpr FP PERIOD = FP(16.0);
-  constexpr FP TIMESTEP = FP(0.160);
+  constexpr double SPEED = 0.0;
 
   Drivers::SineGenerator<FP> sine(100);
   Drivers::StepperPredictiveModel<T> pwm(24, 17.8, 28, 0.0, 0.16, POSITIVE_CHANNEL, NEGATIVE_CHANNEL,
       1024);
+  auto setpoint = [&sine](uint64_t tick) {
+    return sine.calculateSine(static_cast<int>(tick)).asDouble();
+  };
 
-  T In[200];
-  In[0] = 0.0;
-  T error = 0.0;
-  for (int i = 1; i < 200; i++) {
-    if (i == 100) {
-      error = 0.0;
-    }
-
-    T currentI = In[i - 1];
-    auto target = sine.calculateSine(i);
-    auto prevTarget = sine.calculateSine(i-1);
-    auto errorDelta = prevTarget - currentI;
-    error = error + errorDelta * errorDelta;
-    auto deltaI = pidController.computeOutput(currentI, prevTarget);
-    DutyCycle duty = pwm.computeDutyCycle(SPEED, deltaI + target, currentI);
-    for (int j = 0; j < 10; j++) {
-      currentI = plant.computeCurrentAtEndOfCycle(SPEED.asDouble(), currentI.asDouble(), duty);
-    }
-    In[i] = currentI;
-  }
-  checkTolerance(0.001, sqrt(error.asDouble() / 100), 0.001);
+  // the current is held in T between plant cycles as the controller would measure it, and the squared
+  // error is summed in T
+  auto simulation = Drivers::makeSimulation<T, T>(pidController, pwm, plant, NEGATIVE_CHANNEL);
+  simulation.run(99, setpoint, Drivers::ConstantSpeed{SPEED});
+  simulation.resetErrors();
+  simulation.run(100, setpoint, Drivers::ConstantSpeed{SPEED});
+  checkTolerance(0.001, simulation.rmsError(), 0.001);
 }
 
 
@@ -192,19 +180,29 @@ TEST(PidControllerTestFixed, LargeStepOpen) {
   checkTolerance(0.01, In[39], TARGET);
 }
 
-TEST(PidControllerTestFixed, SineHigh) {
+/**
+ * Coils the controller has to track whose resistance and inductance are above and below the model's.
+ */
+struct ActualCoil {
+    double V;
+    double K;
+    double R;
+    double L;
+    double P;
+
+    Drivers::StepperPlantModel<double> plant(
+        Drivers::PlantEvaluation evaluation = Drivers::PlantEvaluation::ANALYTIC) const {
+      return Drivers::StepperPlantModel<double>(V, R, L, K, P, Drivers::PWM_CHANNEL::CHANNEL1,
+          Drivers::PWM_CHANNEL::CHANNEL2, 1024, evaluation);
+    }
+};
 
-  constexpr double actualV = 24.0;
-  constexpr double actualK = 0.0;
-  constexpr double actualR = 18.9;
-  constexpr double actualL = 34;
-  constexpr double actualP = 0.016;
+constexpr ActualCoil HIGH_COIL = {24.0, 0.0, 18.9, 34, 0.016};
+constexpr ActualCoil LOW_COIL = {24.0, 0.0, 14.6, 22.4, 0.016};
 
+TEST(PidControllerTestFixed, SineHigh) {
   Drivers::PidController<FP, Fixed::TestParameters> pidControler;
-  Drivers::StepperPlantModel<double> plant(actualV, actualR, actualL, actualK, actualP, Drivers::PWM_CHANNEL::CHANNEL1,
-      Drivers::PWM_CHANNEL::CHANNEL2, 1024);
-
-  testSineTracking(pidControler, plant);
+  testSineTracking(pidControler, HIGH_COIL.plant());
 }
 
 
@@ -216,17 +214,21 @@ TEST(PidControllerTestFixed, SineHigh) {
  * tolerance.
  */
 TEST(PidControllerTestFixed, SineLow) {
-  constexpr double actualV = 24.0;
-  constexpr double actualK = 0.0;
-  constexpr double actualR = 14.6;
-  constexpr double actualL = 22.4;
-  constexpr double actualP = 0.016;
+  Drivers::PidController<FP, Fixed::TestParameters> pidControler;
+  testSineTracking(pidControler, LOW_COIL.plant());
+}
 
+/**
+ * The same tracking against the plant evaluated from cached decay factors.
+ */
+TEST(PidControllerTestFixed, SineHighCached) {
   Drivers::PidController<FP, Fixed::TestParameters> pidControler;
-  Drivers::StepperPlantModel<double> plant(actualV, actualR, actualL, actualK, actualP, Drivers::PWM_CHANNEL::CHANNEL1,
-      Drivers::PWM_CHANNEL::CHANNEL2, 1024);
+  testSineTracking(pidControler, HIGH_COIL.plant(Drivers::PlantEvaluation::CACHED));
+}
 
-  testSineTracking(pidControler, plant);
+TEST(PidControllerTestFixed, SineLowCached) {
+  Drivers::PidController<FP, Fixed::TestParameters> pidControler;
+  testSineTracking(pidControler, LOW_COIL.plant(Drivers::PlantEvaluation::CACHED));
 }
 
 constexpr FP Fixed::TestParameters::Kd;
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <waveforms/SineGenerator.hpp>
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <tests/drivers/stepper/BatchPlantModel.hpp>
+#include <tests/drivers/stepper/PidGainTuner.hpp>
+#include <tests/drivers/stepper/ClosedLoopSimulation.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using Drivers::DutyCycle;
+using Drivers::PidGains;
+using Drivers::PidGainTuner;
+using FP = numeric::FixedPoint<22>;
+using FP16 = numeric::FixedPoint<16, int32_t>;
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+
+// the gains and limits of TestParameters in the PID tests
+constexpr PidGains CURRENT_GAINS = {-0.35, 0.9, 0.1, 0.1, -0.1, 0.025};
+
+// the controller's CycleBudget statistics are not atomic, so a timed build tunes on one thread
+#ifdef CYCLE_BUDGET
+constexpr uint32_t TUNER_THREADS = 1;
+#else
+constexpr uint32_t TUNER_THREADS = 0;
+#endif
+
+inline double toDouble(double value) {
+  return value;
+}
+
+template<typename T>
+double toDouble(const T &value) {
+  return value.asDouble();
+}
+
+struct Coil {
+    double R;
+    double L;
+};
+
+/**
+ * The units and coil variations of the SineHigh and SineLow tests each number type is tuned for. The
+ * double tests run in SI units; the fixed point tests are scaled to mH and ms so the coil constants keep
+ * their precision in FixedPoint<16>, with the sine in whole ticks.
+ */
+template<typename T>
+struct Harness;
+
+template<>
+struct Harness<double> {
+    static constexpr double MODEL_L = 0.028;
+    static constexpr double TICK = 0.000160;
+    static constexpr double PLANT_PERIOD = 0.000016;
+    static constexpr double EMF_K = 24.0;
+    static constexpr double SINE_STEP = TICK;
+    static constexpr Coil COILS[] = {{18.9, 0.0336}, {15.5, 0.0224}};
+};
+
+template<>
+struct Harness<FP16> {
+    static constexpr double MODEL_L = 28.0;
+    static constexpr double TICK = 0.160;
+    static constexpr double PLANT_PERIOD = 0.016;
+    static constexpr double EMF_K = 0.0;
+    static constexpr double SINE_STEP = 1.0;
+    static constexpr Coil COILS[] = {{18.9, 34.0}, {14.6, 22.4}};
+};
+
+/**
+ * Same loop as testSineTracking in the PID tests for T. Returns the worst RMS tracking error over the
+ * second period across the coil variations.
+ */
+template<typename T>
+double sineTrackingCost(const PidGains &gains) {
+  using Units = Harness<T>;
+  constexpr double SPEED = 0.0;
+  double worst = 0.0;
+  for( const auto &coil : Units::COILS ) {
+    Drivers::RuntimePidController<T> pidController(Drivers::toTuning<T>(gains));
+    Drivers::StepperPlantModel<double> plant(24, coil.R, coil.L, Units::EMF_K, Units::PLANT_PERIOD, POSITIVE_CHANNEL,
+        NEGATIVE_CHANNEL, 1024, Drivers::PlantEvaluation::CACHED);
+    Drivers::SineGenerator<FP> sine(Units::SINE_STEP * 100);
+    Drivers::StepperPredictiveModel<T> pwm(T(24.0), T(17.8), T(Units::MODEL_L), T(0.0), T(Units::TICK),
+        POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024);
+
+    Drivers::SineSetpoint<Drivers::SineGenerator<FP>, double> setpoint(sine, Units::SINE_STEP, 100);
+    auto simulation = Drivers::makeSimulation<T>(pidController, pwm, plant, NEGATIVE_CHANNEL);
+    simulation.run(99, setpoint, Drivers::ConstantSpeed{SPEED});
+    simulation.resetErrors();
+    simulation.run(100, setpoint, Drivers::ConstantSpeed{SPEED});
+    double rms = std::isfinite(simulation.rmsError()) ? simulation.rmsError() : 1e9;
+    worst = std::max(worst, rms);
+  }
+  return worst;
+}
+
+/**
+ * sineTrackingCost for a block of candidates, with every candidate and coil advanced together in one
+ * BatchStepperPlantModel. Each instance has its own controller and model; the tick is the same as in
+ * ClosedLoopSimulation.
+ */
+template<typename T>
+std::vector<double> sineTrackingBatchCost(const std::vector<PidGains> &candidates) {
+  using Units = Harness<T>;
+  constexpr double SPEED = 0.0;
+  constexpr uint32_t COIL_COUNT = sizeof(Units::COILS) / sizeof(Units::COILS[0]);
+  std::vector<Drivers::PlantParameters> parameters;
+  std::vector<Drivers::RuntimePidController<T>> controllers;
+  std::vector<Drivers::StepperPredictiveModel<T>> models;
+  for( const auto &gains : candidates ) {
+    for( const auto &coil : Units::COILS ) {
+      parameters.push_back({24.0, coil.R, coil.L, Units::EMF_K});
+      controllers.emplace_back(Drivers::toTuning<T>(gains));
+      models.emplace_back(T(24.0), T(17.8), T(Units::MODEL_L), T(0.0), T(Units::TICK), POSITIVE_CHANNEL,
+          NEGATIVE_CHANNEL, 1024);
+    }
+  }
+  Drivers::BatchStepperPlantModel plant(parameters, Units::PLANT_PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024);
+  plant.reset(0.0);
+  const uint32_t count = plant.size();
+
+  Drivers::SineGenerator<FP> sine(Units::SINE_STEP * 100);
+  Drivers::SineSetpoint<Drivers::SineGenerator<FP>, double> setpoint(sine, Units::SINE_STEP, 100);
+  std::vector<double> speed(count, SPEED);
+  std::vector<double> previousTarget(count);
+  std::vector<int32_t> duty(count);
+  for( uint64_t tick = 1; tick < 200; tick++ ) {
+    if( tick == 100 ) {
+      plant.resetErrors();
+    }
+    const double target = setpoint(tick);
+    std::fill(previousTarget.begin(), previousTarget.end(), Drivers::previousTarget(setpoint, tick));
+    plant.recordError(previousTarget.data());
+    for( uint32_t i = 0; i < count; i++ ) {
+      const T current = T(plant.current(i));
+      const T correction = controllers[i].computeOutput(current, T(previousTarget[i]));
+      duty[i] = plant.signedDuty(models[i].computeDutyCycle(T(SPEED), correction + T(target), current));
+    }
+    plant.advance(speed.data(), duty.data(), 10);
+  }
+
+  std::vector<double> costs(candidates.size(), 0.0);
+  for( uint32_t i = 0; i < count; i++ ) {
+    double rms = std::isfinite(plant.rmsError(i)) ? plant.rmsError(i) : 1e9;
+    costs[i / COIL_COUNT] = std::max(costs[i / COIL_COUNT], rms);
+  }
+  return costs;
+}
+
+TEST(PidGainTuner, FindsQuadraticMinimum) {
+  auto cost = [](const PidGains &g) {
+    return (g.Kp + 0.35) * (g.Kp + 0.35) + (g.Ki - 0.9) * (g.Ki - 0.9) + (g.Kd - 0.1) * (g.Kd - 0.1);
+  };
+  PidGainTuner tuner(cost, CURRENT_GAINS, 4);
+  auto result = tuner.tune({-1.0, 0.0}, {0.0, 2.0}, {0.0, 0.5}, 5, 200);
+  checkTolerance(0.001, result.gains.Kp, -0.35);
+  checkTolerance(0.001, result.gains.Ki, 0.9);
+  checkTolerance(0.001, result.gains.Kd, 0.1);
+  EXPECT_EQ(result.evaluations > 125u, true);
+}
+
+/**
+ * The grid includes the current gains (Kp -0.35, Ki 0.9, Kd 0.1).
+ */
+TEST(PidGainTuner, NoWorseThanCurrentGains) {
+  const double current = sineTrackingCost<double>(CURRENT_GAINS);
+  PidGainTuner tuner(sineTrackingCost<double>, CURRENT_GAINS, TUNER_THREADS);
+  auto result = tuner.tune({-0.5, -0.2}, {0.6, 1.2}, {0.0, 0.2}, 3, 20);
+  EXPECT_LE(result.cost, current);
+}
+
+TEST(PidGainTuner, NoWorseThanCurrentGainsFixed) {
+  const double current = sineTrackingCost<FP16>(CURRENT_GAINS);
+  PidGainTuner tuner(sineTrackingCost<FP16>, CURRENT_GAINS, TUNER_THREADS);
+  auto result = tuner.tune({-0.5, -0.2}, {0.6, 1.2}, {0.0, 0.2}, 3, 20);
+  EXPECT_LE(result.cost, current);
+}
+
+TEST(PidGainTuner, BatchCostMatchesSingle) {
+  std::vector<PidGains> candidates;
+  for( double kp : {-0.5, -0.35, 0.0} ) {
+    for( double ki : {0.0, 0.9} ) {
+      PidGains gains = CURRENT_GAINS;
+      gains.Kp = kp;
+      gains.Ki = ki;
+      candidates.push_back(gains);
+    }
+  }
+  auto batch = sineTrackingBatchCost<double>(candidates);
+  auto batchFixed = sineTrackingBatchCost<FP16>(candidates);
+  for( size_t i = 0; i < candidates.size(); i++ ) {
+    checkTolerance(1e-9, batch[i], sineTrackingCost<double>(candidates[i]));
+    // rounding the plant current to FixedPoint<16> can turn a 1e-12 difference between the plants into a
+    // count of duty, so the fixed point costs only agree to about a percent
+    checkTolerance(0.001, batchFixed[i], sineTrackingCost<FP16>(candidates[i]));
+  }
+}
+
+TEST(PidGainTuner, BatchNoWorseThanCurrentGains) {
+  const double current = sineTrackingCost<double>(CURRENT_GAINS);
+  PidGainTuner tuner(sineTrackingBatchCost<double>, CURRENT_GAINS, TUNER_THREADS);
+  auto result = tuner.tune({-0.5, -0.2}, {0.6, 1.2}, {0.0, 0.2}, 3, 20);
+  EXPECT_LE(result.cost, current);
+}
+
+/**
+ * Time the grid stage of a sweep with a plant per candidate and with the batch plant, on one thread.
+ */
+TEST(PidGainTuner, DISABLED_BatchSweepCost) {
+  constexpr uint32_t GRID = 7;
+  PidGainTuner single(sineTrackingCost<double>, CURRENT_GAINS, 1);
+  auto start = std::chrono::steady_clock::now();
+  auto singleResult = single.tune({-1.0, 0.0}, {0.0, 2.0}, {0.0, 0.5}, GRID, 0);
+  std::chrono::duration<double, std::milli> singleTime = std::chrono::steady_clock::now() - start;
+
+  PidGainTuner batch(sineTrackingBatchCost<double>, CURRENT_GAINS, 1);
+  start = std::chrono::steady_clock::now();
+  auto batchResult = batch.tune({-1.0, 0.0}, {0.0, 2.0}, {0.0, 0.5}, GRID, 0);
+  std::chrono::duration<double, std::milli> batchTime = std::chrono::steady_clock::now() - start;
+
+  std::cout << GRID * GRID * GRID << " candidates: single plants " << singleTime.count() << " ms, batch plant "
+            << batchTime.count() << " ms" << std::endl;
+  checkTolerance(1e-9, batchResult.cost, singleResult.cost);
+}
+
+/**
+ * Full search, run with --gtest_also_run_disabled_tests and paste the output into the PID tests.
+ */
+TEST(PidGainTuner, DISABLED_TuneSineTracking) {
+  PidGainTuner tunerDouble(sineTrackingBatchCost<double>, CURRENT_GAINS, TUNER_THREADS);
+  auto resultDouble = tunerDouble.tune({-1.0, 0.0}, {0.0, 2.0}, {0.0, 0.5}, 9, 200);
+  std::cout << "double rms=" << resultDouble.cost << " evaluations=" << resultDouble.evaluations << std::endl;
+  Drivers::writeTestParameters(std::cout, resultDouble.gains, "double");
+
+  PidGainTuner tunerFixed(sineTrackingBatchCost<FP16>, CURRENT_GAINS, TUNER_THREADS);
+  auto resultFixed = tunerFixed.tune({-1.0, 0.0}, {0.0, 2.0}, {0.0, 0.5}, 9, 200);
+  std::cout << "FixedPoint<16> rms=" << resultFixed.cost << " evaluations=" << resultFixed.evaluations << std::endl;
+  Drivers::writeTestParameters(std::cout, resultFixed.gains, "numeric::FixedPoint<16, int32_t>");
+}
@@ -4,6 +4,7 @@
 #include <tests/drivers/stepper/StepperTestModel.hpp>
 #include <drivers/timers/PwmTypes.hpp>
 #include <iostream>
+#include <stdexcept>
 
 using Drivers::DutyCycle;
 
@@ -105,3 +106,46 @@ TEST(ModelsTest, Shape) {
   }
 }
 
+/**
+ * Cached and analytic plants with the same coil, compared at every tenth of the duty range on both channels.
+ */
+void checkCachedMatchesAnalytic(double volts, double resistance, double inductance, double backEmf, double period,
+    int32_t ticks, double speed) {
+  Drivers::StepperPlantModel<double> analytic(volts, resistance, inductance, backEmf, period,
+      Drivers::PWM_CHANNEL::CHANNEL1, Drivers::PWM_CHANNEL::CHANNEL2, ticks);
+  Drivers::StepperPlantModel<double> cached(volts, resistance, inductance, backEmf, period,
+      Drivers::PWM_CHANNEL::CHANNEL1, Drivers::PWM_CHANNEL::CHANNEL2, ticks, Drivers::PlantEvaluation::CACHED);
+
+  for (int32_t d = 0; d <= ticks; d += ticks / 10) {
+    for (int32_t i = -10; i <= 10; i++) {
+      double current = i * 0.1;
+      Drivers::DutyCycle positive(static_cast<uint16_t>(d), Drivers::PWM_CHANNEL::CHANNEL1);
+      Drivers::DutyCycle negative(static_cast<uint16_t>(d), Drivers::PWM_CHANNEL::CHANNEL2);
+      checkTolerance(1e-9, cached.computeCurrentAtEndOfCycle(speed, current, positive),
+          analytic.computeCurrentAtEndOfCycle(speed, current, positive));
+      checkTolerance(1e-9, cached.computeCurrentAtEndOfCycle(speed, current, negative),
+          analytic.computeCurrentAtEndOfCycle(speed, current, negative));
+    }
+  }
+}
+
+TEST(ModelsTest, CachedShortPeriods) {
+  checkCachedMatchesAnalytic(24.0, 17.8, 0.028, 0.0, 0.000016, 1000, 0.0);
+}
+
+TEST(ModelsTest, CachedLongPeriods) {
+  checkCachedMatchesAnalytic(24.0, 17.8, 0.028, 0.0, 0.0016, 1000, 0.0);
+}
+
+TEST(ModelsTest, CachedWithBackEmf) {
+  checkCachedMatchesAnalytic(24.0, 18.9, 0.0336, 0.5, 0.000016, 1024, 2.0);
+}
+
+TEST(ModelsTest, CachedDutyOutOfRange) {
+  Drivers::StepperPlantModel<double> cached(24.0, 17.8, 0.028, 0.0, 0.000016,
+      Drivers::PWM_CHANNEL::CHANNEL1, Drivers::PWM_CHANNEL::CHANNEL2, 1000, Drivers::PlantEvaluation::CACHED);
+  Drivers::DutyCycle full(1000, Drivers::PWM_CHANNEL::CHANNEL1);
+  Drivers::DutyCycle over(1001, Drivers::PWM_CHANNEL::CHANNEL1);
+  EXPECT_NO_THROW(cached.computeCurrentAtEndOfCycle(0.0, 0.5, full));
+  EXPECT_THROW(cached.computeCurrentAtEndOfCycle(0.0, 0.5, over), std::out_of_range);
+}
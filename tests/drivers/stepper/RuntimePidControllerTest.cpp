@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/PidController.hpp>
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <SolexOs/datastructures/ByteArray.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using Drivers::PidTuning;
+using Drivers::RuntimePidController;
+using FP16 = numeric::FixedPoint<16, int32_t>;
+
+struct RuntimeTestParameters {
+    typedef double NumType;
+    static constexpr double Kd = 0.1;
+    static constexpr double Kp = -0.35;
+    static constexpr double Ki = 0.9;
+    static constexpr double MAX_OUTPUT_VALUE = 0.1;
+    static constexpr double MIN_OUTPUT_VALUE = -0.1;
+    static constexpr double MAX_INTEGRAL = 0.025;
+    static constexpr double RESET_VALUE_ERROR = 0.0;
+    static constexpr double RESET_VALUE_INTEGRAL = 0.0;
+    static constexpr double RESET_VALUE_SETPOINT = 0.0;
+};
+
+struct FixedParameters {
+    static constexpr FP16 Kd = FP16(0.1);
+    static constexpr FP16 Kp = FP16(-0.35);
+    static constexpr FP16 Ki = FP16(0.9);
+    static constexpr FP16 MAX_OUTPUT_VALUE = FP16(0.1);
+    static constexpr FP16 MIN_OUTPUT_VALUE = FP16(-0.1);
+    static constexpr FP16 MAX_INTEGRAL = FP16(0.025);
+    static constexpr FP16 RESET_VALUE_ERROR = FP16(0.0);
+    static constexpr FP16 RESET_VALUE_INTEGRAL = FP16(0.0);
+    static constexpr FP16 RESET_VALUE_SETPOINT = FP16(0.0);
+};
+
+TEST(RuntimePidControllerTest, FromParameters) {
+  constexpr auto tuning = PidTuning<double>::fromParameters<RuntimeTestParameters>();
+  EXPECT_EQ(tuning.Kp, RuntimeTestParameters::Kp);
+  EXPECT_EQ(tuning.Ki, RuntimeTestParameters::Ki);
+  EXPECT_EQ(tuning.Kd, RuntimeTestParameters::Kd);
+  EXPECT_EQ(tuning.maxOutput, RuntimeTestParameters::MAX_OUTPUT_VALUE);
+  EXPECT_EQ(tuning.minOutput, RuntimeTestParameters::MIN_OUTPUT_VALUE);
+  EXPECT_EQ(tuning.maxIntegral, RuntimeTestParameters::MAX_INTEGRAL);
+  EXPECT_EQ(tuning.resetError, RuntimeTestParameters::RESET_VALUE_ERROR);
+  EXPECT_EQ(tuning.resetIntegral, RuntimeTestParameters::RESET_VALUE_INTEGRAL);
+}
+
+TEST(RuntimePidControllerTest, MatchesCompileTimeGains) {
+  Drivers::PidController<double, RuntimeTestParameters> fixed;
+  RuntimePidController<double> runtime(PidTuning<double>::fromParameters<RuntimeTestParameters>());
+  for( int i = 0; i < 200; i++ ) {
+    double current = 0.5 + 0.1 * sin(i * 0.1);
+    EXPECT_EQ(runtime.computeOutput(current, 0.55), fixed.computeOutput(current, 0.55));
+  }
+}
+
+TEST(RuntimePidControllerTest, SetTuningKeepsHistory) {
+  auto tuning = PidTuning<double>::fromParameters<RuntimeTestParameters>();
+  RuntimePidController<double> pid(tuning);
+  pid.computeOutput(0.51, 0.5);
+  tuning.Kp = 0.0;
+  tuning.Kd = 0.0;
+  pid.setTuning(tuning);
+  EXPECT_EQ(pid.getTuning().Kp, 0.0);
+  // only the integral term is left: (0.01 + 0.01) * 0.9
+  checkTolerance(1e-12, pid.computeOutput(0.51, 0.5), 0.018);
+  pid.reset();
+  checkTolerance(1e-12, pid.computeOutput(0.51, 0.5), 0.009);
+}
+
+TEST(RuntimePidControllerTest, ResetValues) {
+  auto tuning = PidTuning<double>::fromParameters<RuntimeTestParameters>();
+  tuning.Kp = 0.0;
+  tuning.resetError = 0.02;
+  tuning.resetIntegral = 0.01;
+  RuntimePidController<double> pid(tuning);
+  // integral (0.01 + 0.01) * 0.9 and derivative (0.01 - 0.02) * 0.1
+  checkTolerance(1e-12, pid.computeOutput(0.51, 0.5), 0.017);
+  pid.computeOutput(0.52, 0.5);
+  pid.reset();
+  checkTolerance(1e-12, pid.computeOutput(0.51, 0.5), 0.017);
+}
+
+TEST(RuntimePidControllerTest, StreamRoundTrip) {
+  PidTuning<FP16> tuning = {FP16(-0.35), FP16(0.9), FP16(0.1), FP16(0.1), FP16(-0.1), FP16(0.025), FP16(0.002),
+    FP16(0.001)};
+  SolexOs::ByteArray buffer(PidTuning<FP16>::streamSize());
+  auto writeStream = buffer.getWriteStream();
+  tuning.write(writeStream);
+
+  // the fields go out in declaration order
+  auto layout = buffer.getReadStream();
+  EXPECT_EQ(SolexOs::read<FP16>(layout).asRaw(), tuning.Kp.asRaw());
+  EXPECT_EQ(SolexOs::read<FP16>(layout).asRaw(), tuning.Ki.asRaw());
+
+  auto stream = buffer.getReadStream();
+  EXPECT_EQ(stream.bytesLeft(), PidTuning<FP16>::streamSize());
+  PidTuning<FP16> loaded = {};
+  EXPECT_EQ(loaded.read(stream), true);
+  EXPECT_EQ(stream.bytesLeft(), 0u);
+  EXPECT_EQ(loaded.Kp.asRaw(), tuning.Kp.asRaw());
+  EXPECT_EQ(loaded.Ki.asRaw(), tuning.Ki.asRaw());
+  EXPECT_EQ(loaded.Kd.asRaw(), tuning.Kd.asRaw());
+  EXPECT_EQ(loaded.maxOutput.asRaw(), tuning.maxOutput.asRaw());
+  EXPECT_EQ(loaded.minOutput.asRaw(), tuning.minOutput.asRaw());
+  EXPECT_EQ(loaded.maxIntegral.asRaw(), tuning.maxIntegral.asRaw());
+  EXPECT_EQ(loaded.resetError.asRaw(), tuning.resetError.asRaw());
+  EXPECT_EQ(loaded.resetIntegral.asRaw(), tuning.resetIntegral.asRaw());
+}
+
+TEST(RuntimePidControllerTest, ShortStreamRejected) {
+  PidTuning<double> tuning = PidTuning<double>::fromParameters<RuntimeTestParameters>();
+  SolexOs::ByteArray buffer(PidTuning<double>::streamSize());
+  auto writeStream = buffer.getWriteStream();
+  tuning.write(writeStream);
+  buffer.setLength(PidTuning<double>::streamSize() - 1);
+  auto stream = buffer.getReadStream();
+  PidTuning<double> loaded = {};
+  EXPECT_EQ(loaded.read(stream), false);
+  EXPECT_EQ(loaded.Kp, 0.0);
+}
+
+template<typename CONTROLLER, typename T>
+double nanosecondsPerCall(CONTROLLER &controller, const std::vector<T> &samples, T setPoint, T &sink) {
+  constexpr int PASSES = 200;
+  auto start = std::chrono::steady_clock::now();
+  for( int pass = 0; pass < PASSES; pass++ ) {
+    for( const auto &sample : samples ) {
+      sink = sink + controller.computeOutput(sample, setPoint);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (PASSES * samples.size());
+}
+
+/**
+ * Compares computeOutput against the compile time controller. Run with --gtest_also_run_disabled_tests on
+ * an optimised build; the two should be within noise of each other.
+ */
+TEST(RuntimePidControllerTest, DISABLED_ComputeOutputCost) {
+  std::vector<FP16> samples;
+  for( int i = 0; i < 4096; i++ ) {
+    samples.push_back(FP16(0.5 + 0.1 * sin(i * 0.01)));
+  }
+  Drivers::PidController<FP16, FixedParameters> fixed;
+  RuntimePidController<FP16> runtime(PidTuning<FP16>::fromParameters<FixedParameters>());
+
+  FP16 sink(0.0);
+  double fixedNs = nanosecondsPerCall(fixed, samples, FP16(0.55), sink);
+  double runtimeNs = nanosecondsPerCall(runtime, samples, FP16(0.55), sink);
+  std::cout << "constexpr gains " << fixedNs << " ns/call, runtime gains " << runtimeNs << " ns/call (" << sink.asRaw()
+            << ")" << std::endl;
+  EXPECT_LE(runtimeNs, fixedNs * 1.5);
+}
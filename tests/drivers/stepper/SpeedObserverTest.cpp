@@ -0,0 +1,117 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <drivers/stepper/SpeedObserver.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <tests/drivers/stepper/StepperTestModel.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using Drivers::DutyCycle;
+using FP = numeric::FixedPoint<16, int32_t>;
+
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+
+// same scaled units as PidControllerTestFixedPoint: mH and ms
+constexpr double V = 24.0;
+constexpr double R = 17.8;
+constexpr double L = 28.0;
+constexpr double K = 24.0;
+constexpr double PWM_PERIOD = 0.016;
+constexpr uint32_t CYCLES_PER_TICK = 10;
+constexpr double TICK = PWM_PERIOD * CYCLES_PER_TICK;
+constexpr double PI = 3.14159265358979323846;
+
+using FixedPlant = Drivers::StepperPlantModel<FP>;
+
+/**
+ * Track a sine current on a coil turning at a fixed speed, feeding the predictive model either the observer
+ * estimate or a fixed guess. Returns the RMS tracking error over the second half.
+ */
+double trackSine(double trueSpeed, bool useObserver, double &estimate) {
+  constexpr int32_t TICKS = 2000;
+  Drivers::StepperPlantModel<double> plant(V, R, L, K, PWM_PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  FixedPlant predictor(FP(V), FP(R), FP(L), FP(K), FP(PWM_PERIOD), POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  Drivers::SpeedObserver<FP, FixedPlant> observer(predictor, CYCLES_PER_TICK, FP(0.25), FP(0.01));
+  Drivers::RuntimePidController<FP> pid({FP(-0.35), FP(0.9), FP(0.1), FP(0.1), FP(-0.1), FP(0.025), FP(0.0),
+      FP(0.0)});
+  Drivers::StepperPredictiveModel<FP> model(FP(V), FP(R), FP(L), FP(K), FP(TICK), POSITIVE_CHANNEL, NEGATIVE_CHANNEL,
+      1024);
+
+  double current = 0.0;
+  double previousTarget = 0.0;
+  double errorSquared = 0.0;
+  for( int32_t tick = 1; tick < TICKS; tick++ ) {
+    const double target = 0.5 * std::sin(2 * PI * tick / 100);
+    if( tick >= TICKS / 2 ) {
+      errorSquared += (previousTarget - current) * (previousTarget - current);
+    }
+    const FP measured = FP(current);
+    observer.correct(measured);
+    const FP speed = useObserver ? observer.speed() : FP(0.0);
+    const FP deltaI = pid.computeOutput(measured, FP(previousTarget));
+    const DutyCycle duty = model.computeDutyCycle(speed, deltaI + FP(target), measured);
+    observer.predict(measured, duty);
+    for( uint32_t cycle = 0; cycle < CYCLES_PER_TICK; cycle++ ) {
+      current = plant.computeCurrentAtEndOfCycle(trueSpeed, current, duty);
+    }
+    previousTarget = target;
+  }
+  estimate = observer.speed().asDouble();
+  return std::sqrt(errorSquared / (TICKS / 2));
+}
+
+TEST(SpeedObserverTest, ConvergesToSpeed) {
+  for( double speed : {0.0, 0.1, 0.25} ) {
+    double estimate;
+    trackSine(speed, true, estimate);
+    checkTolerance(0.02, estimate, speed);
+  }
+}
+
+TEST(SpeedObserverTest, ImprovesTracking) {
+  double estimate;
+  double withObserver = trackSine(0.25, true, estimate);
+  double withoutObserver = trackSine(0.25, false, estimate);
+  EXPECT_LT(withObserver, withoutObserver);
+}
+
+TEST(SpeedObserverTest, DISABLED_TrackingReport) {
+  for( double speed : {0.0, 0.1, 0.25} ) {
+    double estimate;
+    double withObserver = trackSine(speed, true, estimate);
+    double withoutObserver = trackSine(speed, false, estimate);
+    std::cout << "speed " << speed << " rms error with observer " << withObserver << " without "
+        << withoutObserver << std::endl;
+  }
+}
+
+TEST(SpeedObserverTest, HoldsWhenInsensitive) {
+  FixedPlant predictor(FP(V), FP(R), FP(L), FP(K), FP(PWM_PERIOD), POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  Drivers::SpeedObserver<FP, FixedPlant> observer(predictor, CYCLES_PER_TICK, FP(1.0), FP(100.0), FP(0.2));
+  observer.correct(FP(0.3));
+  EXPECT_EQ(observer.speed().asRaw(), FP(0.2).asRaw());
+  observer.predict(FP(0.0), DutyCycle(900, POSITIVE_CHANNEL));
+  observer.correct(FP(0.3));
+  EXPECT_EQ(observer.speed().asRaw(), FP(0.2).asRaw());
+}
+
+TEST(SpeedObserverTest, SingleStepCorrection) {
+  Drivers::StepperPlantModel<double> plant(V, R, L, K, PWM_PERIOD, POSITIVE_CHANNEL, NEGATIVE_CHANNEL, 1024,
+      Drivers::PlantEvaluation::CACHED);
+  Drivers::SpeedObserver<double, Drivers::StepperPlantModel<double>> observer(plant, CYCLES_PER_TICK, 1.0, 1e-6);
+  const DutyCycle duty(900, POSITIVE_CHANNEL);
+  double current = 0.1;
+  observer.predict(current, duty);
+  for( uint32_t cycle = 0; cycle < CYCLES_PER_TICK; cycle++ ) {
+    current = plant.computeCurrentAtEndOfCycle(0.3, current, duty);
+  }
+  observer.correct(current);
+  // the plant is linear in speed so a full gain recovers the speed in one tick
+  checkTolerance(1e-9, observer.speed(), 0.3);
+}
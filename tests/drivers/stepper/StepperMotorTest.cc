@@ -1,8 +1,145 @@
 #include <cmath>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <numeric/FixedPoint.hpp>
+#include <drivers/stepper/RuntimePidController.hpp>
+#include <drivers/stepper/StepperPredictiveModel.hpp>
+#include <tests/drivers/stepper/StepperMotorModel.hpp>
 #include <testFramework/UnitAssert.hpp>
 
+using Drivers::DutyCycle;
+using FP = numeric::FixedPoint<16, int32_t>;
 
+constexpr Drivers::PwmChannel POSITIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL1;
+constexpr Drivers::PwmChannel NEGATIVE_CHANNEL = Drivers::PWM_CHANNEL::CHANNEL2;
+
+constexpr double PWM_PERIOD = 0.000016;
+constexpr int32_t PWM_CYCLES_PER_TICK = 10;
+constexpr double TICK = PWM_PERIOD * PWM_CYCLES_PER_TICK;
+constexpr double PI = 3.14159265358979323846;
+constexpr double FULL_STEP = PI / 2;
+
+// 1.8 degree NEMA 17 class motor with a small inertial and friction load
+constexpr Drivers::MotorParameters MOTOR = {24.0, 17.8, 0.028, 0.005, 50.0, 1.2e-5, 1e-3, 0.02, PWM_PERIOD, 1024};
+constexpr double PEAK_CURRENT = 0.5;
+// tracking limits once the speed has settled
+constexpr double RMS_LIMIT = 0.05 * PEAK_CURRENT;
+constexpr double MAX_ERROR_LIMIT = 0.1 * PEAK_CURRENT;
+
+// The fixed point controller works in the scaled units of PidControllerTestFixedPoint, mH and ms, so the
+// inductance and tick keep their resolution in FP16. Speeds are then rad/ms and the back emf constant V per
+// rad/ms.
+constexpr double MS_PER_SECOND = 1000.0;
+constexpr double CONTROL_L = MOTOR.L * MS_PER_SECOND;
+constexpr double CONTROL_K = MOTOR.k * MS_PER_SECOND;
+constexpr double CONTROL_TICK = TICK * MS_PER_SECOND;
+
+/**
+ * The fixed point control path for one coil: PID correction then the predictive model.
+ */
+class CoilController {
+  private:
+    Drivers::RuntimePidController<FP> _pid;
+    Drivers::StepperPredictiveModel<FP> _model;
+
+  public:
+    CoilController() :
+            _pid({FP(-0.35), FP(0.9), FP(0.1), FP(0.1), FP(-0.1), FP(0.025), FP(0.0), FP(0.0)}),
+            _model(FP(MOTOR.V), FP(MOTOR.R), FP(CONTROL_L), FP(CONTROL_K), FP(CONTROL_TICK), POSITIVE_CHANNEL,
+                NEGATIVE_CHANNEL, MOTOR.ticks) {
+    }
+
+    /**
+     * speed is the motor model's rad/s.
+     */
+    DutyCycle computeDutyCycle(double speed, double previousTarget, double target, double current) {
+      FP deltaI = _pid.computeOutput(FP(current), FP(previousTarget));
+      return _model.computeDutyCycle(FP(speed / MS_PER_SECOND), deltaI + FP(target), FP(current));
+    }
+};
+
+struct TrackingResult {
+    double rmsError;
+    double maxError;
+    double maxLag;
+};
+
+/**
+ * Microstep the motor up to the given full step rate, hold it there and measure how well the coil currents
+ * follow the commanded sine/cosine and how far the rotor lags the commanded angle.
+ */
+TrackingResult trackAtStepRate(double stepsPerSecond, double seconds) {
+  const int32_t ticks = static_cast<int32_t>(seconds / TICK);
+  const int32_t rampTicks = ticks / 2;
+  const double topSpeed = stepsPerSecond * FULL_STEP;
+
+  Drivers::StepperMotorModel motor(MOTOR, POSITIVE_CHANNEL, NEGATIVE_CHANNEL);
+  CoilController coilA;
+  CoilController coilB;
+
+  double commanded = 0.0;
+  double previousA = PEAK_CURRENT;
+  double previousB = 0.0;
+  double errorSquared = 0.0;
+  double maxError = 0.0;
+  double maxLag = 0.0;
+  int32_t samples = 0;
+  for( int32_t tick = 1; tick < ticks; tick++ ) {
+    const double speed = (tick < rampTicks) ? topSpeed * tick / rampTicks : topSpeed;
+    commanded += speed * TICK;
+    const double targetA = PEAK_CURRENT * std::cos(commanded);
+    const double targetB = PEAK_CURRENT * std::sin(commanded);
+
+    if( tick >= rampTicks ) {
+      const double errorA = std::fabs(previousA - motor.currentA());
+      const double errorB = std::fabs(previousB - motor.currentB());
+      errorSquared += errorA * errorA + errorB * errorB;
+      maxError = std::max(maxError, std::max(errorA, errorB));
+      samples += 2;
+    }
+    maxLag = std::max(maxLag, std::fabs(commanded - motor.angle()));
+
+    DutyCycle dutyA = coilA.computeDutyCycle(motor.speedSeenByA(), previousA, targetA, motor.currentA());
+    DutyCycle dutyB = coilB.computeDutyCycle(motor.speedSeenByB(), previousB, targetB, motor.currentB());
+    for( int32_t cycle = 0; cycle < PWM_CYCLES_PER_TICK; cycle++ ) {
+      motor.runCycle(dutyA, dutyB);
+    }
+    previousA = targetA;
+    previousB = targetB;
+  }
+  return {std::sqrt(errorSquared / samples), maxError, maxLag};
+}
+
+TEST(StepperTest, HoldingPosition) {
+  auto result = trackAtStepRate(0.0, 0.05);
+  EXPECT_LT(result.maxLag, FULL_STEP / 2);
+  EXPECT_LT(result.rmsError, RMS_LIMIT);
+  EXPECT_LT(result.maxError, MAX_ERROR_LIMIT);
+}
 
 TEST(StepperTest, CoilTracking){
+  // 750 full steps/s is a 187.5Hz electrical sine, about 33 control ticks per period
+  auto result = trackAtStepRate(750.0, 0.4);
+  EXPECT_LT(result.maxLag, 2 * FULL_STEP);
+  EXPECT_LT(result.rmsError, RMS_LIMIT);
+  EXPECT_LT(result.maxError, MAX_ERROR_LIMIT);
+}
+
+/**
+ * Raise the step rate until the rotor loses sync or the current tracking passes the limits CoilTracking uses.
+ * Run with --gtest_also_run_disabled_tests.
+ */
+TEST(StepperTest, DISABLED_MaximumStepRate) {
+  double lastGood = 0.0;
+  for( double rate = 250.0; rate <= 8000.0; rate += 250.0 ) {
+    auto result = trackAtStepRate(rate, 0.4);
+    std::cout << rate << " steps/s rms=" << result.rmsError << " max=" << result.maxError << " lag="
+              << result.maxLag / FULL_STEP << " steps" << std::endl;
+    if( result.maxLag >= 2 * FULL_STEP || result.rmsError >= RMS_LIMIT || result.maxError >= MAX_ERROR_LIMIT ) {
+      break;
+    }
+    lastGood = rate;
+  }
+  std::cout << "maximum step rate " << lastGood << " steps/s" << std::endl;
+  EXPECT_GT(lastGood, 0.0);
 }
@@ -0,0 +1,74 @@
+#include <drivers/timers/CycleBudget.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+using Drivers::CycleBudget;
+
+static uint32_t instrumented(uint32_t value) {
+  CYCLE_BUDGET_SCOPE("instrumented");
+  return value * 3;
+}
+
+TEST(CycleBudgetTest, Statistics) {
+  CycleBudget budget("statistics");
+  EXPECT_EQ(budget.min(), 0u);
+  EXPECT_EQ(budget.mean(), 0u);
+  budget.record(1);
+  budget.record(100);
+  budget.record(1000);
+  EXPECT_EQ(budget.count(), 3u);
+  EXPECT_EQ(budget.min(), 1u);
+  EXPECT_EQ(budget.max(), 1000u);
+  EXPECT_EQ(budget.mean(), 367u);
+}
+
+TEST(CycleBudgetTest, Histogram) {
+  CycleBudget budget("histogram");
+  budget.record(0);
+  budget.record(1);
+  budget.record(2);
+  budget.record(3);
+  budget.record(4);
+  budget.record(0xFFFFFFFF);
+  EXPECT_EQ(budget.bin(0), 2u);
+  EXPECT_EQ(budget.bin(1), 2u);
+  EXPECT_EQ(budget.bin(2), 1u);
+  EXPECT_EQ(budget.bin(CycleBudget::BINS - 1), 1u);
+  budget.reset();
+  EXPECT_EQ(budget.count(), 0u);
+  EXPECT_EQ(budget.bin(0), 0u);
+}
+
+TEST(CycleBudgetTest, Scope) {
+  CycleBudget budget("scope");
+  {
+    Drivers::CycleBudgetScope scope(budget);
+    EXPECT_EQ(instrumented(2), 6u);
+  }
+  EXPECT_EQ(budget.count(), 1u);
+}
+
+#ifdef CYCLE_BUDGET
+TEST(CycleBudgetTest, Report) {
+  CycleBudget budget("site");
+  budget.record(2);
+  budget.record(4);
+  testing::internal::CaptureStdout();
+  budget.report();
+  std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_EQ(output, "site 00000002 00000002 00000003 00000004 00000000 00000001 00000001"
+      " 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000 00000000"
+      " 00000000 00000000\n");
+}
+
+TEST(CycleBudgetTest, ReportAllIncludesCallSites) {
+  CycleBudget::resetAll();
+  for( uint32_t i = 0; i < 10; i++ ) {
+    instrumented(i);
+  }
+  testing::internal::CaptureStdout();
+  CycleBudget::reportAll();
+  std::string output = testing::internal::GetCapturedStdout();
+  EXPECT_NE(output.find("instrumented 0000000A "), std::string::npos);
+}
+#endif
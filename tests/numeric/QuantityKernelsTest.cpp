@@ -0,0 +1,124 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <numeric/Units.hpp>
+#include <numeric/Quantity.hpp>
+#include <numeric/QuantityKernels.hpp>
+
+using namespace numeric::SI::FixedPoint;
+using numeric::SI::Quantity;
+using numeric::SI::QuantityLayout;
+
+using A_per_S = numeric::SI::Unit<0,0,-1,1>;
+
+// A quantity must have the same layout as the number it wraps or arrays of them can't be treated as arrays of FP.
+static_assert(QuantityLayout<Volts>::isZeroOverhead, "Volts must have the layout of FP");
+static_assert(QuantityLayout<Amps>::isZeroOverhead, "Amps must have the layout of FP");
+static_assert(QuantityLayout<Quantity<A_per_S, FP>>::isZeroOverhead, "A/s must have the layout of FP");
+
+constexpr uint32_t COUNT = 16;
+
+TEST(QuantityKernelsTest, matchesRawVAR){
+  Volts v[COUNT];
+  Ohms r[COUNT];
+  Amps i[COUNT];
+  for( uint32_t n = 0; n < COUNT; n++){
+    v[n] = Volts(FP(0.5 + n));
+    r[n] = Ohms(FP(2.0 + n/4.0));
+  }
+  numeric::SI::divide(i, v, r, COUNT);
+  for( uint32_t n = 0; n < COUNT; n++){
+    EXPECT_EQ(i[n].value.asRaw(), (v[n].value / r[n].value).asRaw());
+    EXPECT_EQ(i[n], v[n]/r[n]);
+  }
+}
+
+TEST(QuantityKernelsTest, matchesRawHV){
+  Volts v[COUNT];
+  Henries h[COUNT];
+  Quantity<A_per_S, FP> rate[COUNT];
+  for( uint32_t n = 0; n < COUNT; n++){
+    v[n] = Volts(FP(24.0 - n));
+    h[n] = Henries(FP(0.028 * (n + 1)));
+  }
+  numeric::SI::divide(rate, v, h, COUNT);
+  for( uint32_t n = 0; n < COUNT; n++){
+    EXPECT_EQ(rate[n].value.asRaw(), (v[n].value / h[n].value).asRaw());
+  }
+}
+
+TEST(QuantityKernelsTest, scaleAndAccumulate){
+  Amps i[COUNT];
+  Amps scaled[COUNT];
+  Amps total[COUNT];
+  const FP factor = FP(0.75);
+  for( uint32_t n = 0; n < COUNT; n++){
+    i[n] = Amps(FP(n / 8.0));
+    total[n] = Amps(FP(1.0));
+  }
+  numeric::SI::scale(scaled, i, factor, COUNT);
+  numeric::SI::multiplyAccumulate(total, i, factor, COUNT);
+  for( uint32_t n = 0; n < COUNT; n++){
+    EXPECT_EQ(scaled[n].value.asRaw(), (i[n].value * factor).asRaw());
+    EXPECT_EQ(total[n].value.asRaw(), (FP(1.0) + i[n].value * factor).asRaw());
+  }
+}
+
+/**
+ * Runs KERNEL REPEATS times and returns the time per element in ns.
+ */
+template<typename KERNEL>
+double nsPerElement(uint32_t elements, KERNEL kernel) {
+  constexpr uint32_t REPEATS = 2000;
+  auto start = std::chrono::steady_clock::now();
+  for( uint32_t repeat = 0; repeat < REPEATS; repeat++ ) {
+    kernel();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (REPEATS * elements);
+}
+
+TEST(QuantityKernelsTest, DISABLED_QuantityVersusRawCost){
+  constexpr uint32_t ELEMENTS = 1024;
+  static Volts v[ELEMENTS];
+  static Ohms r[ELEMENTS];
+  static Amps i[ELEMENTS];
+  static FP rawV[ELEMENTS];
+  static FP rawR[ELEMENTS];
+  static FP rawI[ELEMENTS];
+  static Amps iSum[ELEMENTS];
+  static FP rawSum[ELEMENTS];
+  for( uint32_t n = 0; n < ELEMENTS; n++){
+    rawV[n] = FP(0.5 + (n % 20));
+    rawR[n] = FP(2.0 + (n % 7) / 4.0);
+    v[n] = Volts(rawV[n]);
+    r[n] = Ohms(rawR[n]);
+  }
+  const FP factor = FP(0.75);
+  const FP undo = FP(-0.75);
+
+  double quantityDivide = nsPerElement(ELEMENTS, [&]() {numeric::SI::divide(i, v, r, ELEMENTS);});
+  double rawDivide = nsPerElement(ELEMENTS, [&]() {
+    for( uint32_t n = 0; n < ELEMENTS; n++){
+      rawI[n] = rawV[n] / rawR[n];
+    }
+  });
+  // accumulate into separate outputs, adding and taking away in turn so they stay in range over the repeats
+  bool add = true;
+  double quantityMac = nsPerElement(ELEMENTS, [&]() {
+    numeric::SI::multiplyAccumulate(iSum, i, add ? factor : undo, ELEMENTS);
+    add = !add;
+  });
+  add = true;
+  double rawMac = nsPerElement(ELEMENTS, [&]() {
+    const FP step = add ? factor : undo;
+    for( uint32_t n = 0; n < ELEMENTS; n++){
+      rawSum[n] = rawSum[n] + rawI[n] * step;
+    }
+    add = !add;
+  });
+
+  std::cout << "ns per element: divide quantity " << quantityDivide << " raw " << rawDivide
+            << ", multiplyAccumulate quantity " << quantityMac << " raw " << rawMac
+            << " (" << iSum[ELEMENTS - 1].value.asRaw() + rawSum[ELEMENTS - 1].asRaw() << ")" << std::endl;
+}
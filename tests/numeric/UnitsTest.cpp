@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <numeric/Units.hpp>
 #include <numeric/Quantity.hpp>
+#include <numeric/QuantityConstants.hpp>
 
 using namespace numeric::SI::FixedPoint;
 using numeric::SI::Quantity;
@@ -69,3 +70,30 @@ TEST(UnitQuantitiesTest, testDivNumber){
   EXPECT_EQ(f.value.asRaw(), static_cast<int>(1.5*FP_ONE) );
 
 }
+
+TEST(UnitQuantitiesTest, testMultConstant){
+  constexpr auto K = numeric::SI::Constant<FP>(2.5);
+  static_assert(K.value.asRaw() == 5*FP_ONE/2, "constant must be folded at compile time");
+
+  Volts v = 3.0_V;
+  auto e = v * K;
+  EXPECT_EQ(e.value.asRaw(), 15*FP_ONE/2 );
+  e = K * v;
+  EXPECT_EQ(e.value.asRaw(), 15*FP_ONE/2 );
+  e = v * 2.5_k;
+  EXPECT_EQ(e.value.asRaw(), 15*FP_ONE/2 );
+}
+
+TEST(UnitQuantitiesTest, testDivConstant){
+  Volts v = 3.0_V;
+  auto e = v / 1.5_k;
+  EXPECT_EQ(e.value.asRaw(), static_cast<int>(2*FP_ONE) );
+  auto f = 4.5_k / v;
+  EXPECT_EQ(f.value.asRaw(), static_cast<int>(1.5*FP_ONE) );
+
+  // multiplying by the reciprocal may be out by the last bit
+  e = v / 2.0_inv;
+  EXPECT_EQ(e.value.asRaw(), static_cast<int>(1.5*FP_ONE) );
+  e = v / 1.5_inv;
+  EXPECT_LE(abs(e.value.asRaw() - static_cast<int>(2*FP_ONE)), 2 );
+}
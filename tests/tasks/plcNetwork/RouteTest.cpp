@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <tasks/plcNetwork/Route.hpp>
+#include <testFramework/NoAllocationScope.hpp>
+#include <utility>
 
 namespace SolexOs {
 
@@ -17,5 +19,21 @@ namespace SolexOs {
     }
   }
 
+  TEST(RouteTest, testMoveDoesNotAllocate) {
+    NoAllocationScope noAllocation;
+    Route route;
+    route.addHop(NodeId::MASTER(), RxQuality(0x90));
+    route.addHop(NodeId::FIRST_SLAVE(), RxQuality(0x80));
+    Route moved(std::move(route));
+    Route other;
+    std::swap(moved, other);
+    int hops = 0;
+    for( auto hop : other.hops() ) {
+      (void)hop;
+      hops++;
+    }
+    EXPECT_EQ(hops, 2);
+  }
+
 }
 
@@ -0,0 +1,67 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <waveforms/InterpolatedSineLookup.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using FP = numeric::FixedPoint<22>;
+using waveforms::Interpolation;
+using waveforms::InterpolatedSineLookup;
+
+constexpr double PI = 3.141592654;
+constexpr double TOLERANCE = 0.00001;
+
+/**
+ * Worst case error over a sweep of the full period that does not line up with the table steps.
+ */
+template<uint32_t SIZE, Interpolation MODE>
+double worstCaseError() {
+  constexpr uint32_t STEPS = 100003;
+  double maxError = 0.0;
+  for( uint32_t i = 0; i < STEPS; i++){
+    uint32_t phase = static_cast<uint32_t>((uint64_t(i) << 32) / STEPS);
+    double expected = sin(2*PI*phase/4294967296.0);
+    double error = fabs(InterpolatedSineLookup<SIZE, MODE>::template calculateSine<FP>(phase).asDouble() - expected);
+    if( error > maxError ){
+      maxError = error;
+    }
+  }
+  std::cout << "quarter table " << SIZE << (MODE == Interpolation::LINEAR ? " linear" : " quadratic")
+            << " bytes=" << InterpolatedSineLookup<SIZE, MODE>::TABLE_BYTES << " max error=" << maxError << std::endl;
+  return maxError;
+}
+
+TEST(InterpolatedSineLookup, CheckBoundaries){
+  using sine = InterpolatedSineLookup<256>;
+  checkTolerance(TOLERANCE, sine::calculateSine<FP>(0), FP(0.0));
+  checkTolerance(TOLERANCE, sine::calculateSine<FP>(0x40000000u), FP(1.0));
+  checkTolerance(TOLERANCE, sine::calculateSine<FP>(0x80000000u), FP(0.0));
+  checkTolerance(TOLERANCE, sine::calculateSine<FP>(0xC0000000u), FP(-1.0));
+  checkTolerance(TOLERANCE, sine::calculateCosine<FP>(0), FP(1.0));
+}
+
+TEST(InterpolatedSineLookup, ErrorVsTableSize){
+  double linear[] = {
+      worstCaseError<16, Interpolation::LINEAR>(),
+      worstCaseError<64, Interpolation::LINEAR>(),
+      worstCaseError<256, Interpolation::LINEAR>(),
+      worstCaseError<1024, Interpolation::LINEAR>()};
+  double quadratic[] = {
+      worstCaseError<16, Interpolation::QUADRATIC>(),
+      worstCaseError<64, Interpolation::QUADRATIC>(),
+      worstCaseError<256, Interpolation::QUADRATIC>(),
+      worstCaseError<1024, Interpolation::QUADRATIC>()};
+
+  // quadratic reaches the resolution of the result by 256 entries so larger tables can only match it
+  constexpr double RESOLUTION = 1.0 / (1 << 22);
+  for( uint32_t i = 1; i < 4; i++){
+    EXPECT_LT(linear[i], linear[i-1]);
+    EXPECT_LE(quadratic[i], quadratic[i-1]);
+    EXPECT_LT(quadratic[i], linear[i]);
+  }
+  EXPECT_LT(quadratic[0], linear[0]);
+  EXPECT_LT(linear[2], TOLERANCE);
+  EXPECT_LT(linear[3], 3 * RESOLUTION);
+  EXPECT_LT(quadratic[1], TOLERANCE);
+  EXPECT_LT(quadratic[3], 2 * RESOLUTION);
+}
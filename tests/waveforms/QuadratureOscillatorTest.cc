@@ -0,0 +1,95 @@
+#include <cmath>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <waveforms/QuadratureOscillator.hpp>
+#include <waveforms/SineOscillator.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using FP = numeric::FixedPoint<22>;
+
+constexpr double TOLERANCE = 0.00001;
+constexpr double PI = 3.141592654;
+
+TEST(QuadratureOscillator, SineCosine){
+  Drivers::QuadratureOscillator<FP> oscillator(100);
+  for( int i=0; i < 200; i++){
+    FP sine;
+    FP cosine;
+    oscillator.next(sine, cosine);
+    checkTolerance(TOLERANCE, sine.asDouble(), sin(2*PI*i/100) );
+    checkTolerance(TOLERANCE, cosine.asDouble(), cos(2*PI*i/100) );
+  }
+}
+
+TEST(QuadratureOscillator, MatchesSeparateLookups){
+  using sine = waveforms::InterpolatedSineLookup<64, waveforms::Interpolation::QUADRATIC>;
+  for( uint32_t i=0; i < 4096; i++){
+    uint32_t phase = i * 1048573u;
+    FP s;
+    FP c;
+    sine::calculateSineCosine(phase, s, c);
+    EXPECT_EQ(s, sine::calculateSine<FP>(phase));
+    EXPECT_EQ(c, sine::calculateCosine<FP>(phase));
+  }
+}
+
+TEST(QuadratureOscillator, DISABLED_SharedDecodeCost){
+  using sine = waveforms::InterpolatedSineLookup<256>;
+  constexpr uint32_t CALLS = 10000000;
+  int64_t sink = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for( uint32_t i=0; i < CALLS; i++){
+    const uint32_t phase = i * 2654435761u;
+    sink += sine::calculateSine<FP>(phase).asRaw() + sine::calculateCosine<FP>(phase).asRaw();
+  }
+  std::chrono::duration<double, std::nano> separate = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  for( uint32_t i=0; i < CALLS; i++){
+    FP s;
+    FP c;
+    sine::calculateSineCosine(i * 2654435761u, s, c);
+    sink += s.asRaw() + c.asRaw();
+  }
+  std::chrono::duration<double, std::nano> shared = std::chrono::steady_clock::now() - start;
+
+  std::cout << "ns per sine and cosine: separate " << separate.count() / CALLS << " shared decode "
+            << shared.count() / CALLS << " (" << sink << ")" << std::endl;
+}
+
+TEST(QuadratureOscillator, FillBuffer){
+  constexpr uint32_t SAMPLES = 100;
+  FP coilA[SAMPLES];
+  FP coilB[SAMPLES];
+  Drivers::QuadratureOscillator<FP> oscillator(FP(0.016), FP(0.00016));
+  Drivers::SineOscillator<FP> reference(SAMPLES);
+  oscillator.fill(coilA, coilB, SAMPLES);
+  for( uint32_t i=0; i < SAMPLES; i++){
+    checkTolerance(0.0025, coilA[i], reference.next());
+    checkTolerance(TOLERANCE, coilA[i].asDouble()*coilA[i].asDouble() + coilB[i].asDouble()*coilB[i].asDouble(), 1.0);
+  }
+}
+
+TEST(MultiPhaseOscillator, ThreePhase){
+  Drivers::MultiPhaseOscillator<FP, 3> oscillator(100);
+  for( int i=0; i < 100; i++){
+    FP out[3];
+    oscillator.next(out);
+    for( int p=0; p < 3; p++){
+      checkTolerance(TOLERANCE, out[p].asDouble(), sin(2*PI*i/100 - 2*PI*p/3) );
+    }
+  }
+}
+
+TEST(MultiPhaseOscillator, FourPhase){
+  Drivers::MultiPhaseOscillator<FP, 4> oscillator(100);
+  for( int i=0; i < 100; i++){
+    FP out[4];
+    oscillator.next(out);
+    for( int p=0; p < 4; p++){
+      checkTolerance(TOLERANCE, out[p].asDouble(), sin(2*PI*i/100 - 2*PI*p/4) );
+    }
+  }
+}
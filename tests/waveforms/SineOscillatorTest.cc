@@ -0,0 +1,57 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <system_error>
+#include <waveforms/SineOscillator.hpp>
+#include <testFramework/UnitAssert.hpp>
+
+using FP = numeric::FixedPoint<22>;
+
+constexpr double TOLERANCE = 0.0025;
+constexpr double PI = 3.141592654;
+
+TEST(SineOscillator, Start0){
+  Drivers::SineOscillator<FP> oscillator(100);
+  EXPECT_EQ(oscillator.next(), FP(0.0));
+}
+
+TEST(SineOscillator, Checkwrap){
+  Drivers::SineOscillator<FP> oscillator(100);
+  for( int i=0; i < 200; i++){
+    FP result = oscillator.next();
+    double expected = sin(2*PI*i/100);
+    checkTolerance(TOLERANCE, result.asDouble(), expected );
+  }
+}
+
+TEST(SineOscillator, MatchesPeriodAndStep){
+  Drivers::SineOscillator<FP> oscillator(FP(0.016), FP(0.00016));
+  Drivers::SineOscillator<FP> reference(100);
+  for( int i=0; i < 200; i++){
+    checkTolerance(TOLERANCE, oscillator.next(), reference.next());
+  }
+}
+
+TEST(SineOscillator, FillBuffer){
+  constexpr uint32_t SAMPLES = 100;
+  FP buffer[SAMPLES];
+  Drivers::SineOscillator<FP> oscillator(SAMPLES);
+  oscillator.fill(buffer, SAMPLES);
+  for( uint32_t i=0; i < SAMPLES; i++){
+    checkTolerance(TOLERANCE, buffer[i].asDouble(), sin(2*PI*i/SAMPLES) );
+  }
+  // a full period must bring the phase back to the start exactly
+  EXPECT_EQ(oscillator.phase(), 0u);
+}
+
+TEST(SineOscillator, NoDrift){
+  Drivers::SineOscillator<FP> oscillator(100);
+  for( uint32_t i=0; i < 100u*10000u; i++){
+    oscillator.advance();
+  }
+  EXPECT_EQ(oscillator.phase(), 0u);
+}
+
+TEST(SineOscillator, ZeroPeriodRejected){
+  EXPECT_THROW(Drivers::SineOscillator<FP> oscillator(0u), std::system_error);
+  EXPECT_THROW(Drivers::SineOscillator<FP> oscillator(FP(0.0), FP(0.00016)), std::system_error);
+}
@@ -0,0 +1,50 @@
+#include <SolexOs/debug/TraceDecoder.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+/**
+ * traceDecode <elf> <log>
+ *
+ * Print the text of a binary trace log using the token table of the ELF image that wrote it. Build on the
+ * host with SolexOs/debug/TraceDecoder.cpp, for example
+ *   g++ -std=c++17 -Iincludes tools/traceDecode.cpp SolexOs/debug/TraceDecoder.cpp -o traceDecode
+ * Token collisions in the table are reported on stderr and give exit code 2, since the log cannot tell
+ * those strings apart.
+ */
+namespace {
+  bool readFile(const char *path, std::vector<uint8_t> &contents) {
+    std::ifstream file(path, std::ios::binary);
+    if( !file ) {
+      return false;
+    }
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+  }
+}
+
+int main(int argc, char **argv) {
+  if( argc != 3 ) {
+    std::cerr << "usage: " << argv[0] << " <elf> <log>" << std::endl;
+    return 1;
+  }
+  std::vector<uint8_t> elf;
+  std::vector<uint8_t> log;
+  if( !readFile(argv[1], elf) || !readFile(argv[2], log) ) {
+    std::cerr << "cannot read " << argv[1] << " or " << argv[2] << std::endl;
+    return 1;
+  }
+  SolexOs::Trace::TokenTable table;
+  if( !table.addElf(elf.data(), elf.size()) ) {
+    std::cerr << argv[1] << " has no readable trace_tokens section" << std::endl;
+    return 1;
+  }
+  for( uint32_t token : table.collisions() ) {
+    std::fprintf(stderr, "token %08X is shared by more than one string, first is \"%s\"\n", token,
+        table.lookup(token));
+  }
+  std::cout << SolexOs::Trace::decode(log.data(), log.size(), table);
+  return table.collisions().empty() ? 0 : 2;
+}